@@ -0,0 +1,100 @@
+/*
+  ==============================================================================
+
+    HazardPointer.h
+    Created: 19 Oct 2026 9:12:40am
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Hands objects from the message thread to a single reader thread, usually the audio thread, without that
+// thread ever locking, allocating or freeing. The message thread owns every object it publishes. The
+// reader announces the object it is reading, and the message thread only releases objects that are
+// neither live nor announced.
+template <typename ObjectType>
+class HazardPointer
+{
+public:
+    // Message thread. Makes the object the live one, and releases earlier ones the reader has moved on from.
+    void publish(std::shared_ptr<ObjectType> object)
+    {
+        live.store(object.get());
+        if (object != nullptr){
+            owned.push_back(std::move(object));
+        }
+        
+        const auto* liveObject = live.load();
+        const auto* objectInUse = inUse.load();
+        owned.erase(std::remove_if(owned.begin(), owned.end(), [&](const auto& ownedObject)
+        {
+            return ownedObject.get() != liveObject && ownedObject.get() != objectInUse;
+        }), owned.end());
+    }
+    
+    // Message thread. The object stays owned until the next publish(), in case it's still being read.
+    void clear() noexcept
+    {
+        live.store(nullptr);
+    }
+    
+    ObjectType* getLive() const noexcept
+    {
+        return live.load();
+    }
+    
+    // Reader thread. Makes the object that was live when it was created safe to use until it is destroyed.
+    class ScopedRead
+    {
+    public:
+        explicit ScopedRead(HazardPointer& hazardPointerToRead) noexcept : hazardPointer(hazardPointerToRead)
+        {
+            // Announce which object is being read before using it, re-checking in case it was swapped in between.
+            object = hazardPointer.live.load();
+            for (;;)
+            {
+                hazardPointer.inUse.store(object);
+                auto* const latestObject = hazardPointer.live.load();
+                if (latestObject == object){
+                    break;
+                }
+                object = latestObject;
+            }
+        }
+        
+        ~ScopedRead()
+        {
+            hazardPointer.inUse.store(nullptr);
+        }
+        
+        ObjectType* get() const noexcept
+        {
+            return object;
+        }
+        
+        ObjectType* operator->() const noexcept
+        {
+            return object;
+        }
+    
+    private:
+        HazardPointer& hazardPointer;
+        ObjectType* object = nullptr;
+        
+        JUCE_DECLARE_NON_COPYABLE(ScopedRead)
+    };
+    
+    // Reader thread. Stops the object from being live, unless another one has been published since.
+    void compareAndClear(ObjectType* expectedObject) noexcept
+    {
+        live.compare_exchange_strong(expectedObject, nullptr);
+    }
+
+private:
+    std::vector<std::shared_ptr<ObjectType>> owned;
+    std::atomic<ObjectType*> live{ nullptr };
+    std::atomic<ObjectType*> inUse{ nullptr };
+};
@@ -0,0 +1,445 @@
+/*
+  ==============================================================================
+
+    HostSimulator.cpp
+    Created: 19 Oct 2026 6:55:30am
+
+  ==============================================================================
+*/
+
+#include "HostSimulator.h"
+
+class HostSimulator::WorkerThread : public Thread
+{
+public:
+    WorkerThread(const String& name, std::function<void()> body) : Thread(name), function(std::move(body))
+    {
+    }
+    
+    ~WorkerThread() override
+    {
+        stopThread(10000);
+    }
+    
+    void run() override
+    {
+        function();
+    }
+    
+private:
+    const std::function<void()> function;
+};
+
+bool HostSimulator::Report::passed() const noexcept
+{
+    return numDeadlineMisses == 0 && numInconsistentStates == 0 && numRealtimeViolations == 0;
+}
+
+String HostSimulator::Report::toString() const
+{
+    String text;
+    text << "Blocks: " << numBlocks << ", deadline " << String(deadlineMs, 3) << " ms, missed " << numDeadlineMisses << newLine
+         << "Block time (ms): mean " << String(meanBlockMs, 4) << ", median " << String(medianBlockMs, 4)
+         << ", 99% " << String(p99BlockMs, 4) << ", 99.9% " << String(p999BlockMs, 4) << ", max " << String(maxBlockMs, 4) << newLine
+         << "Preset operations: " << numPresetOperations << ", state operations: " << numStateOperations << newLine
+         << "Inconsistent states: " << numInconsistentStates << ", real-time violations: " << numRealtimeViolations << newLine;
+    
+    for (const auto& problem : problems){
+        text << problem << newLine;
+    }
+    
+    text << (passed() ? "PASSED" : "FAILED");
+    return text;
+}
+
+HostSimulator::HostSimulator(Options optionsToUse)
+    : options(optionsToUse),
+      periodMs(1000.0 * options.blockSize / options.sampleRate),
+      periodTicks((int64) (Time::getHighResolutionTicksPerSecond() * options.blockSize / options.sampleRate))
+{
+    // Enough bins to see how far past the deadline slow blocks go, without allocating while running.
+    blockTimeHistogram.assign((size_t) (periodMs * 1000.0 * 4.0) + 1, 0);
+}
+
+HostSimulator::~HostSimulator()
+{
+}
+
+HostSimulator::Report HostSimulator::run()
+{
+    // Workers need the message thread to be free to grant them its lock.
+    jassert(!MessageManager::getInstance()->isThisTheMessageThread());
+    
+    RealtimeSafety::resetViolations();
+    
+    {
+        const MessageManagerLock mmLock;
+        presetRoot = File::getSpecialLocation(File::SpecialLocationType::tempDirectory).getNonexistentChildFile("HostSimulator", {}, false);
+        presetRoot.createDirectory();
+        
+        processor = std::make_unique<PluginPresetManagerAudioProcessor>();
+        processor->getPresetManager().setLayers({ { "User", presetRoot, true } });
+        processor->setRateAndBufferSizeDetails(options.sampleRate, options.blockSize);
+        processor->prepareToPlay(options.sampleRate, options.blockSize);
+        
+        createSeedPresets();
+        
+        auto& presetManager = processor->getPresetManager();
+        for (const auto& presetName : presetManager.getAllPresets())
+        {
+            if (const auto values = presetManager.getPresetValues(presetName)){
+                addKnownState(*values);
+            }
+        }
+        
+        addKnownState(presetManager.readParameterSnapshot());
+        numPrograms = processor->getNumPrograms();
+    }
+    
+    {
+        std::vector<std::unique_ptr<WorkerThread>> workers;
+        
+        auto audioThread = std::make_unique<WorkerThread>("Simulated audio", [this] { runAudioThread(); });
+        if (options.useRealtimePriority){
+            audioThread->startRealtimeThread(Thread::RealtimeOptions{}.withPeriodMs(periodMs));
+        } else {
+            audioThread->startThread(Thread::Priority::highest);
+        }
+        workers.push_back(std::move(audioThread));
+        
+        for (int index = 0; index < options.numPresetThreads; ++index)
+        {
+            workers.push_back(std::make_unique<WorkerThread>("Simulated preset UI " + String(index), [this, index] { runPresetThread(index); }));
+            workers.back()->startThread();
+        }
+        
+        for (int index = 0; index < options.numStateThreads; ++index)
+        {
+            workers.push_back(std::make_unique<WorkerThread>("Simulated state saving " + String(index), [this, index] { runStateThread(index); }));
+            workers.back()->startThread();
+        }
+        
+        const auto endTime = Time::getCurrentTime() + options.duration;
+        while (Time::getCurrentTime() < endTime){
+            Thread::sleep(100);
+        }
+        
+        shouldStop = true;
+    }
+    
+    {
+        const MessageManagerLock mmLock;
+        processor->releaseResources();
+        processor.reset();
+        presetRoot.deleteRecursively();
+    }
+    
+    return buildReport();
+}
+
+void HostSimulator::runAudioThread()
+{
+    AudioBuffer<float> buffer{ 2, options.blockSize };
+    MidiBuffer midiMessages;
+    midiMessages.ensureSize(64);
+    
+    Random random{ options.randomSeed };
+    const auto ticksPerMicrosecond = (double) Time::getHighResolutionTicksPerSecond() / 1.0e6;
+    const auto phaseIncrement = MathConstants<double>::twoPi * 440.0 / options.sampleRate;
+    auto phase = 0.0;
+    auto nextBlockTime = Time::getHighResolutionTicks();
+    
+    while (!shouldStop.load())
+    {
+        for (int sample = 0; sample < options.blockSize; ++sample)
+        {
+            const auto value = 0.25f * (float) std::sin(phase);
+            for (int channel = 0; channel < buffer.getNumChannels(); ++channel){
+                buffer.setSample(channel, sample, value);
+            }
+            phase = std::fmod(phase + phaseIncrement, MathConstants<double>::twoPi);
+        }
+        
+        midiMessages.clear();
+        const auto numProgramsToUse = jmin(128, numPrograms.load());
+        if (options.programChangeInterval > 0 && numProgramsToUse > 0 && numBlocks % options.programChangeInterval == 0){
+            midiMessages.addEvent(MidiMessage::programChange(1, random.nextInt(numProgramsToUse)), random.nextInt(options.blockSize));
+        }
+        
+        const auto blockStart = Time::getHighResolutionTicks();
+        processor->processBlock(buffer, midiMessages);
+        const auto blockTicks = Time::getHighResolutionTicks() - blockStart;
+        
+        ++numBlocks;
+        totalBlockTicks += blockTicks;
+        maxBlockTicks = jmax(maxBlockTicks, blockTicks);
+        if (blockTicks > periodTicks){
+            ++numDeadlineMisses;
+        }
+        
+        const auto bin = jmin((int64) blockTimeHistogram.size() - 1, (int64) (blockTicks / ticksPerMicrosecond));
+        ++blockTimeHistogram[(size_t) bin];
+        
+        // Paced like a sound card: the next block is due one period after the last was due. After an
+        // overrun the schedule restarts from now, as a host's would after a dropout.
+        nextBlockTime += periodTicks;
+        if (Time::getHighResolutionTicks() > nextBlockTime)
+        {
+            nextBlockTime = Time::getHighResolutionTicks();
+            continue;
+        }
+        
+        for (auto now = Time::getHighResolutionTicks(); now < nextBlockTime && !shouldStop.load(); now = Time::getHighResolutionTicks())
+        {
+            const auto remainingMs = Time::highResolutionTicksToSeconds(nextBlockTime - now) * 1000.0;
+            if (remainingMs > 2.0){
+                Thread::sleep((int) remainingMs - 1);
+            } else {
+                Thread::yield();
+            }
+        }
+    }
+}
+
+void HostSimulator::runPresetThread(int threadIndex)
+{
+    Random random{ options.randomSeed + threadIndex + 1 };
+    
+    while (!shouldStop.load())
+    {
+        {
+            const MessageManagerLock mmLock{ Thread::getCurrentThread() };
+            if (!mmLock.lockWasGained()){
+                return;
+            }
+            
+            auto& presetManager = processor->getPresetManager();
+            const auto operation = random.nextInt(100);
+            
+            if (operation < 40)
+            {
+                const auto presetNames = presetManager.getAllPresets();
+                if (!presetNames.isEmpty()){
+                    presetManager.loadPreset(presetNames[random.nextInt(presetNames.size())]);
+                }
+            }
+            else if (operation < 70)
+            {
+                presetManager.nextPreset();
+            }
+            else if (operation < 85)
+            {
+                presetManager.previousPreset();
+            }
+            else
+            {
+                const auto presetName = "HostSimulator Save " + String(random.nextInt(numSavedPresetNames));
+                presetManager.savePreset(presetName);
+                
+                if (const auto values = presetManager.getPresetValues(presetName)){
+                    addKnownState(*values);
+                }
+            }
+            
+            numPrograms = processor->getNumPrograms();
+        }
+        
+        ++numPresetOperations;
+        Thread::sleep(random.nextInt(5));
+    }
+}
+
+void HostSimulator::runStateThread(int threadIndex)
+{
+    Random random{ options.randomSeed + options.numPresetThreads + threadIndex + 1 };
+    std::vector<MemoryBlock> recentStates;
+    
+    while (!shouldStop.load())
+    {
+        MemoryBlock stateData;
+        const auto shouldRestore = !recentStates.empty() && random.nextInt(4) == 0;
+        const MemoryBlock* restoredState = nullptr;
+        uint32 generationAfterRestore = 0;
+        
+        {
+            std::unique_ptr<MessageManagerLock> mmLock;
+            if (options.stateCallsHoldMessageManagerLock)
+            {
+                mmLock = std::make_unique<MessageManagerLock>(Thread::getCurrentThread());
+                if (!mmLock->lockWasGained()){
+                    return;
+                }
+            }
+            
+            if (shouldRestore)
+            {
+                restoredState = &recentStates[(size_t) random.nextInt((int) recentStates.size())];
+                processor->setStateInformation(restoredState->getData(), (int) restoredState->getSize());
+                generationAfterRestore = processor->getPresetManager().getStateGeneration();
+            }
+            
+            processor->setStateCompression(static_cast<StateChunk::Tier>(random.nextInt(4)));
+            processor->getStateInformation(stateData);
+        }
+        
+        checkState(stateData);
+        
+        // Unless something else replaced the state in between, a host reads back what it just restored.
+        if (restoredState != nullptr && processor->getPresetManager().getStateGeneration() == generationAfterRestore){
+            checkStateRestored(*restoredState, stateData);
+        }
+        
+        if (recentStates.size() < 8){
+            recentStates.push_back(std::move(stateData));
+        } else {
+            recentStates[(size_t) random.nextInt(8)] = std::move(stateData);
+        }
+        
+        ++numStateOperations;
+        Thread::sleep(random.nextInt(10));
+    }
+}
+
+void HostSimulator::createSeedPresets()
+{
+    auto& presetManager = processor->getPresetManager();
+    Random random{ options.randomSeed };
+    for (int index = 0; index < numSeedPresets; ++index)
+    {
+        auto values = Parameters::getDefaultValues();
+        for (int parameter = 0; parameter < Parameters::numParameters; ++parameter)
+        {
+            const auto& descriptor = Parameters::descriptors[(size_t) parameter];
+            values[(size_t) parameter] = jmap(random.nextFloat(), descriptor.minValue, descriptor.maxValue);
+        }
+        
+        const auto presetName = "HostSimulator Seed " + String(index);
+        presetManager.applyParameterValues(values);
+        presetManager.savePreset(presetName);
+    }
+}
+
+void HostSimulator::addKnownState(const Parameters::Values& values)
+{
+    const ScopedLock sl(knownStatesLock);
+    knownStates.push_back(values);
+}
+
+void HostSimulator::checkState(const MemoryBlock& stateData)
+{
+    const auto state = StateChunk::read(stateData.getData(), (int) stateData.getSize());
+    if (!state.isValid())
+    {
+        reportProblem("A saved state could not be read back");
+        return;
+    }
+    
+    const auto values = processor->getPresetManager().decodeParameterValues(state);
+    
+    String description;
+    auto isInRange = true;
+    for (int index = 0; index < Parameters::numParameters; ++index)
+    {
+        const auto& descriptor = Parameters::descriptors[(size_t) index];
+        const auto value = values[(size_t) index];
+        isInRange = isInRange && std::isfinite(value) && value >= descriptor.minValue && value <= descriptor.maxValue;
+        description << Parameters::toString(descriptor.id) << "=" << value << " ";
+    }
+    
+    if (!isInRange)
+    {
+        reportProblem("State out of range: " + description);
+        return;
+    }
+    
+    // Every operation applies a whole preset, so a state that matches none was captured mid-switch.
+    const auto matchesKnownState = [&values](const Parameters::Values& knownValues)
+    {
+        for (int index = 0; index < Parameters::numParameters; ++index)
+        {
+            const auto& descriptor = Parameters::descriptors[(size_t) index];
+            const auto tolerance = 1.0e-4f * (descriptor.maxValue - descriptor.minValue);
+            if (std::abs(values[(size_t) index] - knownValues[(size_t) index]) > tolerance){
+                return false;
+            }
+        }
+        return true;
+    };
+    
+    const ScopedLock sl(knownStatesLock);
+    if (std::none_of(knownStates.begin(), knownStates.end(), matchesKnownState)){
+        reportProblem("State matches no whole preset: " + description);
+    }
+}
+
+void HostSimulator::checkStateRestored(const MemoryBlock& restoredData, const MemoryBlock& stateData)
+{
+    auto& presetManager = processor->getPresetManager();
+    const auto restoredValues = presetManager.decodeParameterValues(StateChunk::read(restoredData.getData(), (int) restoredData.getSize()));
+    const auto values = presetManager.decodeParameterValues(StateChunk::read(stateData.getData(), (int) stateData.getSize()));
+    
+    String description;
+    auto matches = true;
+    for (int index = 0; index < Parameters::numParameters; ++index)
+    {
+        const auto& descriptor = Parameters::descriptors[(size_t) index];
+        const auto tolerance = 1.0e-4f * (descriptor.maxValue - descriptor.minValue);
+        if (std::abs(values[(size_t) index] - restoredValues[(size_t) index]) > tolerance)
+        {
+            matches = false;
+            description << Parameters::toString(descriptor.id) << " set " << restoredValues[(size_t) index]
+                        << ", got " << values[(size_t) index] << " ";
+        }
+    }
+    
+    if (!matches){
+        reportProblem("State read straight after a restore differs from it: " + description);
+    }
+}
+
+void HostSimulator::reportProblem(const String& problem)
+{
+    ++numInconsistentStates;
+    
+    const ScopedLock sl(knownStatesLock);
+    if (problems.size() < maxProblems){
+        problems.add(problem);
+    }
+}
+
+HostSimulator::Report HostSimulator::buildReport() const
+{
+    Report report;
+    report.numBlocks = numBlocks;
+    report.numDeadlineMisses = numDeadlineMisses;
+    report.deadlineMs = periodMs;
+    report.maxBlockMs = Time::highResolutionTicksToSeconds(maxBlockTicks) * 1000.0;
+    report.meanBlockMs = numBlocks > 0 ? Time::highResolutionTicksToSeconds(totalBlockTicks) * 1000.0 / (double) numBlocks : 0.0;
+    
+    const auto getPercentileMs = [this](double percentile)
+    {
+        const auto target = (int64) std::ceil(percentile * (double) numBlocks);
+        int64 count = 0;
+        for (size_t bin = 0; bin < blockTimeHistogram.size(); ++bin)
+        {
+            count += blockTimeHistogram[bin];
+            if (count >= target){
+                return (double) bin / 1000.0;
+            }
+        }
+        return (double) blockTimeHistogram.size() / 1000.0;
+    };
+    
+    report.medianBlockMs = getPercentileMs(0.5);
+    report.p99BlockMs = getPercentileMs(0.99);
+    report.p999BlockMs = getPercentileMs(0.999);
+    
+    report.numPresetOperations = numPresetOperations.load();
+    report.numStateOperations = numStateOperations.load();
+    report.numInconsistentStates = numInconsistentStates.load();
+    report.numRealtimeViolations = RealtimeSafety::getTotalViolationCount();
+    
+    report.problems = problems;
+    report.problems.addArray(RealtimeSafety::getViolationReports());
+    return report;
+}
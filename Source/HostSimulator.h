@@ -0,0 +1,129 @@
+/*
+  ==============================================================================
+
+    HostSimulator.h
+    Created: 19 Oct 2026 6:55:30am
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+
+// A headless stand-in for a host, for soak testing preset switching under load. It runs processBlock on
+// a real-time thread paced to a fixed buffer size, while other threads keep loading, stepping through
+// and saving presets (holding the message manager lock, as a UI would) and capturing and restoring
+// session state. It reports the distribution of block times, deadline misses, any state that doesn't
+// match a whole preset or doesn't read back as it was restored, and real-time safety violations when
+// PPM_REALTIME_SAFETY_CHECKS is enabled.
+//
+// run() blocks, and must be called from a background thread while the message thread is dispatching,
+// e.g. from a console app that calls MessageManager::runDispatchLoop() on its main thread, as
+// Tests/PluginPresetManagerTests.jucer does. The processor's library is a temporary folder, seeded with
+// presets at the start and deleted again at the end, so the user's own presets are never touched.
+class HostSimulator
+{
+public:
+    struct Options
+    {
+        double sampleRate = 48000.0;
+        int blockSize = 128;
+        RelativeTime duration = RelativeTime::seconds(60.0);
+        int numPresetThreads = 2;
+        int numStateThreads = 1;
+        
+        // Blocks between MIDI program changes; 0 sends none.
+        int programChangeInterval = 64;
+        
+        // Hosts usually save and restore state on the message thread, but some do it from any thread.
+        bool stateCallsHoldMessageManagerLock = true;
+        
+        bool useRealtimePriority = true;
+        int64 randomSeed = 1;
+    };
+    
+    struct Report
+    {
+        int64 numBlocks = 0;
+        int64 numDeadlineMisses = 0;
+        double deadlineMs = 0.0;
+        double meanBlockMs = 0.0;
+        double medianBlockMs = 0.0;
+        double p99BlockMs = 0.0;
+        double p999BlockMs = 0.0;
+        double maxBlockMs = 0.0;
+        
+        int64 numPresetOperations = 0;
+        int64 numStateOperations = 0;
+        int64 numInconsistentStates = 0;
+        int numRealtimeViolations = 0;
+        
+        // The first few inconsistencies and violations, in full.
+        StringArray problems;
+        
+        bool passed() const noexcept;
+        
+        String toString() const;
+    };
+    
+    explicit HostSimulator(Options options = {});
+    
+    ~HostSimulator();
+    
+    Report run();
+    
+private:
+    class WorkerThread;
+    
+    void runAudioThread();
+    
+    void runPresetThread(int threadIndex);
+    
+    void runStateThread(int threadIndex);
+    
+    void createSeedPresets();
+    
+    void addKnownState(const Parameters::Values& values);
+    
+    // Checks that a captured state decodes, is in range, and matches a whole preset rather than a mix.
+    void checkState(const MemoryBlock& stateData);
+    
+    // Checks that a state read straight after a restore has the parameters that were restored.
+    void checkStateRestored(const MemoryBlock& restoredData, const MemoryBlock& stateData);
+    
+    void reportProblem(const String& problem);
+    
+    Report buildReport() const;
+    
+    static constexpr int numSeedPresets = 8;
+    static constexpr int numSavedPresetNames = 8;
+    static constexpr int maxProblems = 32;
+    
+    const Options options;
+    const double periodMs;
+    const int64 periodTicks;
+    
+    std::unique_ptr<PluginPresetManagerAudioProcessor> processor;
+    std::atomic<bool> shouldStop{ false };
+    std::atomic<int> numPrograms{ 0 };
+    File presetRoot;
+    
+    // Written only by the audio thread while it runs; one bin per microsecond, plus one for overruns.
+    std::vector<int64> blockTimeHistogram;
+    int64 numBlocks = 0;
+    int64 numDeadlineMisses = 0;
+    int64 totalBlockTicks = 0;
+    int64 maxBlockTicks = 0;
+    
+    std::atomic<int64> numPresetOperations{ 0 };
+    std::atomic<int64> numStateOperations{ 0 };
+    std::atomic<int64> numInconsistentStates{ 0 };
+    
+    CriticalSection knownStatesLock;
+    std::vector<Parameters::Values> knownStates;
+    StringArray problems;
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(HostSimulator);
+};
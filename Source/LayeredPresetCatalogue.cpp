@@ -0,0 +1,216 @@
+/*
+  ==============================================================================
+
+    LayeredPresetCatalogue.cpp
+    Created: 19 Oct 2026 6:44:01am
+
+  ==============================================================================
+*/
+
+#include "LayeredPresetCatalogue.h"
+
+LayeredPresetCatalogue::LayeredPresetCatalogue(std::vector<Layer> layersToMerge, const String& extension)
+    : layers(std::move(layersToMerge))
+{
+    for (const auto& layer : layers)
+    {
+        catalogues.push_back(std::make_unique<PresetCatalogue>(layer.directory, extension, layer.catalogueFile));
+        catalogues.back()->onChange = [this] { mergeIfNeeded(); };
+    }
+}
+
+LayeredPresetCatalogue::~LayeredPresetCatalogue()
+{
+    // The scanning threads call back into this object, so all of them have to stop before any is destroyed.
+    for (auto& catalogue : catalogues){
+        catalogue->stopScanning();
+    }
+    catalogues.clear();
+}
+
+std::shared_ptr<const PresetCatalogue::Snapshot> LayeredPresetCatalogue::getSnapshot()
+{
+    for (auto& catalogue : catalogues){
+        catalogue->getSnapshot();
+    }
+    mergeIfNeeded();
+    return getCachedSnapshot();
+}
+
+std::shared_ptr<const PresetCatalogue::Snapshot> LayeredPresetCatalogue::getCachedSnapshot() const
+{
+    const SpinLock::ScopedLockType sl(snapshotLock);
+    return snapshot;
+}
+
+void LayeredPresetCatalogue::invalidate(int layerIndex)
+{
+    if (isPositiveAndBelow(layerIndex, (int) catalogues.size())){
+        catalogues[(size_t) layerIndex]->invalidate();
+    }
+}
+
+void LayeredPresetCatalogue::addEntries(int layerIndex, std::vector<PresetCatalogue::Entry> entries)
+{
+    if (isPositiveAndBelow(layerIndex, (int) catalogues.size())){
+        catalogues[(size_t) layerIndex]->addEntries(std::move(entries));
+    }
+}
+
+void LayeredPresetCatalogue::setMetadata(const String& key, const std::map<String, String>& valuesByName)
+{
+    // Before the first merge nothing says which layer a name comes from, so every layer queues them all.
+    // Only names a layer actually has are applied there.
+    const auto merged = getCachedSnapshot();
+    if (merged == nullptr)
+    {
+        for (auto& catalogue : catalogues){
+            catalogue->setMetadata(key, valuesByName);
+        }
+        return;
+    }
+    
+    std::vector<std::map<String, String>> valuesByLayer(catalogues.size());
+    for (const auto& entry : merged->entries)
+    {
+        const auto found = valuesByName.find(entry.name);
+        if (found != valuesByName.end()){
+            valuesByLayer[(size_t) entry.layer][entry.name] = found->second;
+        }
+    }
+    
+    for (size_t layerIndex = 0; layerIndex < catalogues.size(); ++layerIndex)
+    {
+        if (!valuesByLayer[layerIndex].empty()){
+            catalogues[layerIndex]->setMetadata(key, valuesByLayer[layerIndex]);
+        }
+    }
+}
+
+void LayeredPresetCatalogue::scanInBackground()
+{
+    for (auto& catalogue : catalogues){
+        catalogue->scanInBackground();
+    }
+}
+
+bool LayeredPresetCatalogue::needsScan() const
+{
+    return std::any_of(catalogues.begin(), catalogues.end(), [](const auto& catalogue)
+    {
+        return catalogue->needsScan();
+    });
+}
+
+int LayeredPresetCatalogue::getNumLayers() const
+{
+    return (int) layers.size();
+}
+
+const LayeredPresetCatalogue::Layer& LayeredPresetCatalogue::getLayer(int layerIndex) const
+{
+    jassert(isPositiveAndBelow(layerIndex, getNumLayers()));
+    return layers[(size_t) layerIndex];
+}
+
+int LayeredPresetCatalogue::getWritableLayer() const
+{
+    for (int layerIndex = getNumLayers(); --layerIndex >= 0;)
+    {
+        if (layers[(size_t) layerIndex].isWritable){
+            return layerIndex;
+        }
+    }
+    return -1;
+}
+
+int LayeredPresetCatalogue::readStoredEntryCount(const std::vector<Layer>& layersToRead, const String& extension)
+{
+    int numEntries = 0;
+    for (const auto& layer : layersToRead)
+    {
+        const auto catalogueFile = layer.catalogueFile != File() ? layer.catalogueFile
+                                                                 : PresetCatalogue::getDefaultCatalogueFile(layer.directory, extension);
+        numEntries += PresetCatalogue::readStoredEntryCount(catalogueFile);
+    }
+    return numEntries;
+}
+
+void LayeredPresetCatalogue::mergeIfNeeded()
+{
+    const ScopedLock sl(mergeLock);
+    
+    std::vector<std::shared_ptr<const PresetCatalogue::Snapshot>> sources;
+    for (const auto& catalogue : catalogues)
+    {
+        sources.push_back(catalogue->getCachedSnapshot());
+        
+        // Publishing a partial view would briefly hide presets that are about to reappear.
+        if (sources.back() == nullptr){
+            return;
+        }
+    }
+    
+    if (sources == mergedFrom){
+        return;
+    }
+    
+    auto merged = std::make_shared<PresetCatalogue::Snapshot>();
+    
+    size_t totalEntries = 0;
+    for (const auto& source : sources){
+        totalEntries += source->entries.size();
+    }
+    merged->entries.reserve(totalEntries);
+    
+    // A k-way merge of the sorted roots. On equal names every cursor moves on, but only the entry from
+    // the layer with the highest precedence is kept.
+    std::vector<size_t> cursors(sources.size(), 0);
+    for (;;)
+    {
+        int winner = -1;
+        for (int layerIndex = 0; layerIndex < (int) sources.size(); ++layerIndex)
+        {
+            const auto& entries = sources[(size_t) layerIndex]->entries;
+            if (cursors[(size_t) layerIndex] == entries.size()){
+                continue;
+            }
+            
+            if (winner < 0
+                || PresetCatalogue::compareNames(entries[cursors[(size_t) layerIndex]].name,
+                                                 sources[(size_t) winner]->entries[cursors[(size_t) winner]].name) <= 0)
+            {
+                winner = layerIndex;
+            }
+        }
+        
+        if (winner < 0){
+            break;
+        }
+        
+        auto entry = sources[(size_t) winner]->entries[cursors[(size_t) winner]];
+        for (size_t layerIndex = 0; layerIndex < sources.size(); ++layerIndex)
+        {
+            const auto& entries = sources[layerIndex]->entries;
+            if (cursors[layerIndex] < entries.size() && entries[cursors[layerIndex]].name == entry.name){
+                ++cursors[layerIndex];
+            }
+        }
+        
+        entry.layer = winner;
+        merged->entries.push_back(std::move(entry));
+    }
+    
+    // A derived preset may be based on one from another layer, or on one that a later layer overrides.
+    PresetCatalogue::resolveAll(*merged);
+    
+    mergedFrom = std::move(sources);
+    {
+        const SpinLock::ScopedLockType snapshotScopedLock(snapshotLock);
+        snapshot = std::move(merged);
+    }
+    
+    if (onChange != nullptr){
+        onChange();
+    }
+}
@@ -0,0 +1,84 @@
+/*
+  ==============================================================================
+
+    LayeredPresetCatalogue.h
+    Created: 19 Oct 2026 6:44:01am
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "PresetCatalogue.h"
+
+// Several preset roots merged into one view. Each root has its own catalogue, scanned and cached
+// independently, so a change in one root never rescans the others. The merged snapshot is rebuilt
+// only when one of them publishes, by merging their already sorted entries. Where the same name
+// exists in more than one root, the later layer overrides the earlier ones.
+class LayeredPresetCatalogue
+{
+public:
+    struct Layer
+    {
+        String name;
+        File directory;
+        bool isWritable = false;
+        
+        // Where the layer's sidecar goes, if not in the directory itself. Read-only layers need one, or
+        // anything stored in their sidecar, like group labels, is lost at the end of the session.
+        File catalogueFile;
+    };
+    
+    // Layers are given in order of precedence, lowest first.
+    LayeredPresetCatalogue(std::vector<Layer> layers, const String& extension);
+    
+    ~LayeredPresetCatalogue();
+    
+    // Returns an up-to-date merged catalogue, scanning any out of date root on the calling thread.
+    std::shared_ptr<const PresetCatalogue::Snapshot> getSnapshot();
+    
+    // Returns whatever was merged last without touching the disk. Null until every root has been scanned.
+    std::shared_ptr<const PresetCatalogue::Snapshot> getCachedSnapshot() const;
+    
+    // Marks a single root as out of date, so only that one rescans.
+    void invalidate(int layerIndex);
+    
+    // Publishes already decoded entries into one root, which then merges without rescanning.
+    void addEntries(int layerIndex, std::vector<PresetCatalogue::Entry> entries);
+    
+    // Sets one metadata value on the named presets, in whichever root each one comes from.
+    void setMetadata(const String& key, const std::map<String, String>& valuesByName);
+    
+    void scanInBackground();
+    
+    bool needsScan() const;
+    
+    int getNumLayers() const;
+    
+    const Layer& getLayer(int layerIndex) const;
+    
+    // The layer saving and deleting act on. Returns -1 if no layer is writable.
+    int getWritableLayer() const;
+    
+    // The number of presets the layers' sidecars held last session, read from their headers alone. Presets
+    // that override one in a lower layer are counted twice, so this is an upper bound.
+    static int readStoredEntryCount(const std::vector<Layer>& layers, const String& extension);
+    
+    // Called on whichever thread finished a scan, whenever a new merged snapshot is published.
+    std::function<void()> onChange;
+    
+private:
+    // Rebuilds the merged snapshot if any root has published since the last merge.
+    void mergeIfNeeded();
+    
+    const std::vector<Layer> layers;
+    std::vector<std::unique_ptr<PresetCatalogue>> catalogues;
+    
+    CriticalSection mergeLock;
+    std::vector<std::shared_ptr<const PresetCatalogue::Snapshot>> mergedFrom;
+    mutable SpinLock snapshotLock;
+    std::shared_ptr<const PresetCatalogue::Snapshot> snapshot;
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LayeredPresetCatalogue);
+};
@@ -0,0 +1,116 @@
+/*
+  ==============================================================================
+
+    ParameterPanel.h
+    Created: 19 Oct 2026 6:39:52am
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Parameters.h"
+#include "PresetManager.h"
+
+// One slider per parameter, refreshed from the parameter snapshot once per timer tick instead of through
+// a listener per parameter. A preset change therefore costs a single pass over the sliders, however many
+// parameters it touches.
+class ParameterPanel : public Component, Slider::Listener, Timer
+{
+public:
+    ParameterPanel(AudioProcessorValueTreeState& tree, PresetManager& pm) : presetManager(pm)
+    {
+        for (int index = 0; index < Parameters::numParameters; ++index)
+        {
+            const auto& descriptor = Parameters::descriptors[(size_t) index];
+            auto* parameter = tree.getParameter(Parameters::toString(descriptor.id));
+            jassert(parameter != nullptr);
+            parameters[(size_t) index] = parameter;
+            
+            auto& label = labels[(size_t) index];
+            label.setText(parameter->getName(64), dontSendNotification);
+            addAndMakeVisible(label);
+            
+            auto& slider = sliders[(size_t) index];
+            slider.setSliderStyle(Slider::LinearHorizontal);
+            slider.setTextBoxStyle(Slider::TextBoxRight, false, 60, 20);
+            slider.setRange(descriptor.minValue, descriptor.maxValue);
+            slider.setDoubleClickReturnValue(true, descriptor.defaultValue);
+            addAndMakeVisible(slider);
+            slider.addListener(this);
+        }
+        
+        displayedValues.fill(std::numeric_limits<float>::quiet_NaN());
+        refreshFromSnapshot();
+        startTimerHz(refreshRateHz);
+    }
+    
+    ~ParameterPanel() override
+    {
+        for (auto& slider : sliders)
+            slider.removeListener(this);
+    }
+    
+    void resized() override
+    {
+        auto bounds = getLocalBounds().reduced(4);
+        const auto rowHeight = jmin(30, bounds.getHeight() / jmax(1, Parameters::numParameters));
+        
+        for (int index = 0; index < Parameters::numParameters; ++index)
+        {
+            auto row = bounds.removeFromTop(rowHeight);
+            labels[(size_t) index].setBounds(row.removeFromLeft(row.proportionOfWidth(0.3)));
+            sliders[(size_t) index].setBounds(row);
+        }
+    }
+    
+private:
+    void timerCallback() override
+    {
+        refreshFromSnapshot();
+    }
+    
+    void refreshFromSnapshot()
+    {
+        const auto values = presetManager.readParameterSnapshot();
+        
+        for (size_t index = 0; index < values.size(); ++index)
+        {
+            auto& slider = sliders[index];
+            if (values[index] == displayedValues[index] || slider.isMouseButtonDown())
+                continue;
+            
+            displayedValues[index] = values[index];
+            slider.setValue(values[index], dontSendNotification);
+        }
+    }
+    
+    void sliderValueChanged(Slider* slider) override
+    {
+        const auto index = (size_t) std::distance(sliders.data(), slider);
+        auto* parameter = parameters[index];
+        displayedValues[index] = (float) slider->getValue();
+        parameter->setValueNotifyingHost(parameter->convertTo0to1(displayedValues[index]));
+    }
+    
+    void sliderDragStarted(Slider* slider) override
+    {
+        parameters[(size_t) std::distance(sliders.data(), slider)]->beginChangeGesture();
+    }
+    
+    void sliderDragEnded(Slider* slider) override
+    {
+        parameters[(size_t) std::distance(sliders.data(), slider)]->endChangeGesture();
+    }
+    
+    static constexpr int refreshRateHz = 30;
+    
+    PresetManager& presetManager;
+    std::array<RangedAudioParameter*, Parameters::numParameters> parameters;
+    std::array<Slider, Parameters::numParameters> sliders;
+    std::array<Label, Parameters::numParameters> labels;
+    Parameters::Values displayedValues;
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ParameterPanel);
+};
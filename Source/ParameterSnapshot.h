@@ -0,0 +1,127 @@
+/*
+  ==============================================================================
+
+    ParameterSnapshot.h
+    Created: 19 Oct 2026 6:32:14am
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Parameters.h"
+
+// A seqlock-protected copy of every parameter value as one contiguous array, so that any thread can read a
+// consistent set of values without copying the ValueTree. The processor refreshes it once per block.
+//
+// The seqlock only makes the copy consistent, not what it copies: the live values can be halfway through
+// changing to another preset. Whoever applies a whole state therefore brackets it with beginApply() and
+// endApply(), which publishes the complete result, and update() leaves the snapshot alone in between.
+class ParameterSnapshot
+{
+public:
+    ParameterSnapshot(AudioProcessorValueTreeState& tree)
+    {
+        for (int index = 0; index < Parameters::numParameters; ++index)
+        {
+            sources[index] = tree.getRawParameterValue(Parameters::toString(Parameters::descriptors[index].id));
+            jassert(sources[index] != nullptr);
+        }
+        update();
+    }
+    
+    // Copies the live values, unless a state is being applied or another thread is already publishing.
+    void update() noexcept
+    {
+        if (writing.test_and_set(std::memory_order_acquire)){
+            return;
+        }
+        if (applyDepth.load(std::memory_order_acquire) == 0){
+            writeLiveValues();
+        }
+        writing.clear(std::memory_order_release);
+    }
+    
+    void beginApply() noexcept
+    {
+        applyDepth.fetch_add(1, std::memory_order_acq_rel);
+    }
+    
+    // Several applies handed to another thread can be ended at once. Only the last apply to end publishes,
+    // as an earlier one would overwrite what a later one has already queued.
+    void endApply(int numApplies = 1) noexcept
+    {
+        lockWriter();
+        if (applyDepth.fetch_sub(numApplies, std::memory_order_acq_rel) == numApplies){
+            writeLiveValues();
+        }
+        writing.clear(std::memory_order_release);
+    }
+    
+    // Publishes values that have been queued for another thread to apply, between beginApply() and the
+    // endApply() that follows once they have been.
+    void publish(const Parameters::Values& valuesToPublish) noexcept
+    {
+        lockWriter();
+        write([&](int index) { return valuesToPublish[index]; });
+        writing.clear(std::memory_order_release);
+    }
+    
+    Parameters::Values read() const noexcept
+    {
+        Parameters::Values result;
+        for (;;)
+        {
+            const auto sequenceBeforeRead = sequence.load(std::memory_order_acquire);
+            if ((sequenceBeforeRead & 1) != 0){
+                continue;
+            }
+            
+            for (int index = 0; index < Parameters::numParameters; ++index){
+                result[index] = values[index].load(std::memory_order_relaxed);
+            }
+            
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence.load(std::memory_order_relaxed) == sequenceBeforeRead){
+                return result;
+            }
+        }
+    }
+    
+private:
+    // Another writer only ever holds this for one copy of the values.
+    void lockWriter() noexcept
+    {
+        while (writing.test_and_set(std::memory_order_acquire)){
+            continue;
+        }
+    }
+    
+    void writeLiveValues() noexcept
+    {
+        write([this](int index) { return sources[index]->load(std::memory_order_relaxed); });
+    }
+    
+    template <typename ValueSource>
+    void write(ValueSource&& getValue) noexcept
+    {
+        const auto sequenceBeforeWrite = sequence.load(std::memory_order_relaxed);
+        sequence.store(sequenceBeforeWrite + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        
+        for (int index = 0; index < Parameters::numParameters; ++index){
+            values[index].store(getValue(index), std::memory_order_relaxed);
+        }
+        
+        sequence.store(sequenceBeforeWrite + 2, std::memory_order_release);
+    }
+    
+    std::array<std::atomic<float>*, Parameters::numParameters> sources;
+    std::array<std::atomic<float>, Parameters::numParameters> values{};
+    std::atomic<uint32_t> sequence{ 0 };
+    std::atomic_flag writing = ATOMIC_FLAG_INIT;
+    std::atomic<int> applyDepth{ 0 };
+    
+    JUCE_DECLARE_NON_COPYABLE(ParameterSnapshot)
+};
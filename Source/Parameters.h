@@ -0,0 +1,127 @@
+/*
+  ==============================================================================
+
+    Parameters.h
+    Created: 19 Oct 2026 6:31:33am
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <string_view>
+
+struct ParameterDescriptor
+{
+    std::string_view id;
+    std::string_view name;
+    float minValue;
+    float maxValue;
+    float defaultValue;
+};
+
+// Single source of truth for the parameter layout. The position of a descriptor in this table is the
+// parameter's index everywhere else: in createParameterLayout(), in decoded presets and in binary formats.
+namespace Parameters
+{
+    constexpr int versionHint = 1;
+    
+    constexpr std::array<ParameterDescriptor, 4> descriptors
+    {{
+        { "GAIN_ID",      "GAIN_NAME",      0.f, 1.f, 0.f  },
+        { "THRESHOLD_ID", "THRESHOLD_NAME", 0.f, 1.f, 1.f  },
+        { "ATTACK_ID",    "ATTACK_NAME",    0.f, 1.f, 0.2f },
+        { "RELEASE_ID",   "RELEASE_NAME",   0.f, 1.f, 0.2f },
+    }};
+    
+    constexpr int numParameters = static_cast<int>(descriptors.size());
+    
+    // Parameter values in the parameters' own ranges, indexed by descriptor position.
+    using Values = std::array<float, numParameters>;
+    
+    constexpr uint32_t hash(std::string_view text, uint32_t seed)
+    {
+        auto result = 2166136261u ^ seed;
+        for (const auto character : text)
+        {
+            result ^= static_cast<uint8_t>(character);
+            result *= 16777619u;
+        }
+        return result;
+    }
+    
+    constexpr int hashTableSize = [] {
+        auto size = 1;
+        while (size < numParameters * 2)
+            size *= 2;
+        return size;
+    }();
+    
+    constexpr bool isCollisionFree(uint32_t seed)
+    {
+        std::array<bool, hashTableSize> used{};
+        for (const auto& descriptor : descriptors)
+        {
+            const auto slot = hash(descriptor.id, seed) % hashTableSize;
+            if (used[slot])
+                return false;
+            used[slot] = true;
+        }
+        return true;
+    }
+    
+    // Searches for the first seed that maps every ID to its own slot, giving a perfect hash from ID to index.
+    constexpr uint32_t hashSeed = [] {
+        uint32_t seed = 0;
+        while (!isCollisionFree(seed))
+            ++seed;
+        return seed;
+    }();
+    
+    constexpr std::array<int, hashTableSize> hashTable = [] {
+        std::array<int, hashTableSize> table{};
+        for (auto& slot : table)
+            slot = -1;
+        for (int index = 0; index < numParameters; ++index)
+            table[hash(descriptors[index].id, hashSeed) % hashTableSize] = index;
+        return table;
+    }();
+    
+    // Returns the index of the parameter with the given ID, or -1 if it isn't part of the layout.
+    constexpr int indexOf(std::string_view id)
+    {
+        const auto index = hashTable[hash(id, hashSeed) % hashTableSize];
+        return index >= 0 && descriptors[index].id == id ? index : -1;
+    }
+    
+    // Identifies this exact layout, so that binary data written by a different layout can be rejected.
+    constexpr uint32_t layoutHash = [] {
+        auto result = hash({}, static_cast<uint32_t>(numParameters));
+        for (const auto& descriptor : descriptors)
+            result = hash(descriptor.id, result);
+        return result;
+    }();
+    
+    constexpr Values getDefaultValues()
+    {
+        Values values{};
+        for (int index = 0; index < numParameters; ++index)
+            values[index] = descriptors[index].defaultValue;
+        return values;
+    }
+    
+    inline int getIndex(const String& id)
+    {
+        return indexOf(std::string_view{ id.toRawUTF8(), id.getNumBytesAsUTF8() });
+    }
+    
+    inline String toString(std::string_view text)
+    {
+        return String{ text.data(), text.size() };
+    }
+    
+    static_assert(indexOf("GAIN_ID") == 0 && indexOf("RELEASE_ID") == numParameters - 1, "Parameter hash table is broken");
+    static_assert(indexOf("NOT_A_PARAMETER") == -1, "Parameter hash table is broken");
+}
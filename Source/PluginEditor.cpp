@@ -11,9 +11,9 @@
 
 //==============================================================================
 PluginPresetManagerAudioProcessorEditor::PluginPresetManagerAudioProcessorEditor (PluginPresetManagerAudioProcessor& p)
-: presetPanel(p.getPresetManager()), AudioProcessorEditor (&p), genericAudioProcessorEditor(p), audioProcessor (p)
+: presetPanel(p.getPresetManager(), p.previewPlayer), AudioProcessorEditor (&p), parameterPanel(p.tree, p.getPresetManager()), audioProcessor (p)
 {
-    addAndMakeVisible(genericAudioProcessorEditor);
+    addAndMakeVisible(parameterPanel);
     
     addAndMakeVisible(presetPanel);
     
@@ -40,6 +40,6 @@ void PluginPresetManagerAudioProcessorEditor::paint (juce::Graphics& g)
 void PluginPresetManagerAudioProcessorEditor::resized()
 {
     
-    genericAudioProcessorEditor.setBounds(getLocalBounds().withSizeKeepingCentre(getLocalBounds().proportionOfWidth(0.9), proportionOfHeight(0.5)));
+    parameterPanel.setBounds(getLocalBounds().withSizeKeepingCentre(getLocalBounds().proportionOfWidth(0.9), proportionOfHeight(0.5)));
     presetPanel.setBounds(getLocalBounds().removeFromTop(proportionOfHeight(0.1)));
 }
@@ -11,6 +11,7 @@
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
 #include "PresetPanel.h"
+#include "ParameterPanel.h"
 
 //==============================================================================
 /**
@@ -26,7 +27,7 @@ public:
     void resized() override;
 
 private:
-    GenericAudioProcessorEditor genericAudioProcessorEditor; 
+    ParameterPanel parameterPanel;
     
     PresetPanel presetPanel;
         
@@ -24,7 +24,11 @@ PluginPresetManagerAudioProcessor::PluginPresetManagerAudioProcessor()
 {
     tree.state.setProperty(PresetManager::presetNameProperty, "", nullptr);
     tree.state.setProperty("version", ProjectInfo::versionString, nullptr);
-    presetManager = std::make_unique<PresetManager>(tree);
+    presetManager = std::make_unique<PresetManager>(tree, parameterSnapshot);
+    
+   #if PPM_REALTIME_SAFETY_CHECKS
+    stateMutationWatcher = std::make_unique<RealtimeSafety::ValueTreeMutationWatcher>(tree.state);
+   #endif
 }
 
 PluginPresetManagerAudioProcessor::~PluginPresetManagerAudioProcessor()
@@ -71,22 +75,24 @@ double PluginPresetManagerAudioProcessor::getTailLengthSeconds() const
 
 int PluginPresetManagerAudioProcessor::getNumPrograms()
 {
-    return 1;   // NB: some hosts don't cope very well if you tell them there are 0 programs,
-                // so this should be at least 1, even if you're not really implementing programs.
+    // NB: some hosts don't cope very well if you tell them there are 0 programs,
+    // so this should be at least 1, even with an empty preset library.
+    return juce::jmax (1, presetManager->getNumPrograms());
 }
 
 int PluginPresetManagerAudioProcessor::getCurrentProgram()
 {
-    return 0;
+    return juce::jmax (0, presetManager->getCurrentProgram());
 }
 
 void PluginPresetManagerAudioProcessor::setCurrentProgram (int index)
 {
+    presetManager->setCurrentProgram (index);
 }
 
 const juce::String PluginPresetManagerAudioProcessor::getProgramName (int index)
 {
-    return {};
+    return presetManager->getProgramName (index);
 }
 
 void PluginPresetManagerAudioProcessor::changeProgramName (int index, const juce::String& newName)
@@ -98,6 +104,13 @@ void PluginPresetManagerAudioProcessor::prepareToPlay (double sampleRate, int sa
 {
     // Use this method as the place to do any pre-playback
     // initialisation that you need..
+    
+    // MIDI program changes are applied from pre-decoded presets, so start decoding
+    // the library in the background. Offline bounces need it as much as playback does.
+    if (loadsPresetLibrary)
+        presetManager->prepareCatalogue();
+    
+    previewPlayer.setSampleRate (sampleRate);
 }
 
 void PluginPresetManagerAudioProcessor::releaseResources()
@@ -135,6 +148,48 @@ bool PluginPresetManagerAudioProcessor::isBusesLayoutSupported (const BusesLayou
 void PluginPresetManagerAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
     juce::ScopedNoDenormals noDenormals;
+    RealtimeSafety::ScopedRealtime realtimeScope;
+    presetManager->processPendingPresets();
+    
+    // Program changes take effect at their exact sample position, so the block is
+    // rendered in pieces either side of each one.
+    const auto numSamples = buffer.getNumSamples();
+    auto startSample = 0;
+    
+    for (const auto metadata : midiMessages)
+    {
+        const auto message = metadata.getMessage();
+        
+        if (message.isController())
+        {
+            if (message.getControllerNumber() == 0)
+                bankSelectMsb = message.getControllerValue();
+            else if (message.getControllerNumber() == 32)
+                bankSelectLsb = message.getControllerValue();
+            continue;
+        }
+        
+        if (! message.isProgramChange())
+            continue;
+        
+        const auto programSample = juce::jlimit (startSample, numSamples, metadata.samplePosition);
+        processSubBlock (buffer, startSample, programSample - startSample);
+        startSample = programSample;
+        
+        const auto bank = bankSelectMsb * 128 + bankSelectLsb;
+        presetManager->applyProgramFromAudioThread (bank * 128 + message.getProgramChangeNumber());
+    }
+    
+    processSubBlock (buffer, startSample, numSamples - startSample);
+    previewPlayer.renderNextBlock (buffer);
+    parameterSnapshot.update();
+}
+
+void PluginPresetManagerAudioProcessor::processSubBlock (juce::AudioBuffer<float>& buffer, int startSample, int numSamples)
+{
+    if (numSamples <= 0)
+        return;
+    
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
 
@@ -145,7 +200,7 @@ void PluginPresetManagerAudioProcessor::processBlock (juce::AudioBuffer<float>&
     // when they first compile a plugin, but obviously you don't need to keep
     // this code if your algorithm always overwrites all the output channels.
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
-        buffer.clear (i, 0, buffer.getNumSamples());
+        buffer.clear (i, startSample, numSamples);
 
     // This is the place where you'd normally do the guts of your plugin's
     // audio processing...
@@ -155,7 +210,7 @@ void PluginPresetManagerAudioProcessor::processBlock (juce::AudioBuffer<float>&
     // interleaved by keeping the same state.
     for (int channel = 0; channel < totalNumInputChannels; ++channel)
     {
-        auto* channelData = buffer.getWritePointer (channel);
+        auto* channelData = buffer.getWritePointer (channel, startSample);
 
         // ..do something to the data...
     }
@@ -175,19 +230,26 @@ juce::AudioProcessorEditor* PluginPresetManagerAudioProcessor::createEditor()
 //==============================================================================
 void PluginPresetManagerAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
 {
-    const auto state = tree.copyState();
-    const auto xml = state.createXml();
-    copyXmlToBinary(*xml, destData);
+    auto state = presetManager->createStateFromSnapshot();
+    state.setProperty(PresetManager::derivedStorageProperty, presetManager->isDerivedStorageEnabled(), nullptr);
+    state.appendChild(presetManager->getQuickSlotState(), nullptr);
+    StateChunk::write(state, destData, stateCompression.load(), stateWriteHistory);
 }
 
 void PluginPresetManagerAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
-    const auto xmlState = getXmlFromBinary(data, sizeInBytes);
-    if (xmlState == nullptr){
+    auto newTree = StateChunk::read(data, sizeInBytes);
+    if (!newTree.isValid()){
         return;
     }
-    const auto newTree = ValueTree::fromXml(*xmlState);
-    tree.replaceState(newTree);
+    const auto quickSlotState = newTree.getChildWithName(PresetManager::quickSlotsType);
+    presetManager->setQuickSlotState(quickSlotState);
+    newTree.removeChild(quickSlotState, nullptr);
+    
+    // A session setting rather than part of the sound, so it stays out of the parameter tree.
+    presetManager->setDerivedStorageEnabled(newTree.getProperty(PresetManager::derivedStorageProperty, false));
+    newTree.removeProperty(PresetManager::derivedStorageProperty, nullptr);
+    presetManager->restoreState(newTree);
 }
 
 //==============================================================================
@@ -202,15 +264,13 @@ AudioProcessorValueTreeState::ParameterLayout PluginPresetManagerAudioProcessor:
 {
     std::vector<std::unique_ptr<RangedAudioParameter>> params;
     
-    auto gainParam = std::make_unique<juce::AudioParameterFloat>(ParameterID{"GAIN_ID", 1}, "GAIN_NAME", NormalisableRange<float>(0.f, 1.f, 0.f), 0.f);
-    auto thresholdinDBParam = std::make_unique<juce::AudioParameterFloat>(ParameterID{"THRESHOLD_ID", 1}, "THRESHOLD_NAME", NormalisableRange<float>(0.f, 1.f, 0.f), 1.f);
-    auto attackInMSParam = std::make_unique<juce::AudioParameterFloat>(ParameterID{"ATTACK_ID", 1}, "ATTACK_NAME", NormalisableRange<float>(0.f, 1.f, 0.f), 0.2f);
-    auto releaseInMSParam = std::make_unique<juce::AudioParameterFloat>(ParameterID{"RELEASE_ID", 1}, "RELEASE_NAME", NormalisableRange<float>(0.f, 1.f, 0.f), 0.2f);
-    
-    params.push_back(std::move(gainParam));
-    params.push_back(std::move(thresholdinDBParam));
-    params.push_back(std::move(attackInMSParam));
-    params.push_back(std::move(releaseInMSParam));
+    for (const auto& descriptor : Parameters::descriptors)
+    {
+        params.push_back(std::make_unique<juce::AudioParameterFloat>(ParameterID{Parameters::toString(descriptor.id), Parameters::versionHint},
+                                                                     Parameters::toString(descriptor.name),
+                                                                     NormalisableRange<float>(descriptor.minValue, descriptor.maxValue, 0.f),
+                                                                     descriptor.defaultValue));
+    }
 
     return {params.begin(), params.end()};
 }
@@ -10,6 +10,9 @@
 
 #include <JuceHeader.h>
 #include "PresetManager.h"
+#include "PresetAuditioner.h"
+#include "RealtimeSafety.h"
+#include "StateChunk.h"
 
 
 //==============================================================================
@@ -55,14 +58,37 @@ public:
     void getStateInformation (juce::MemoryBlock& destData) override;
     void setStateInformation (const void* data, int sizeInBytes) override;
     
+    // How getStateInformation() compresses the state. Every tier can be read back regardless.
+    void setStateCompression (StateChunk::Tier tier) { stateCompression = tier; }
+    
+    // Private instances that only ever render given values, like the preset auditioner's, opt out of
+    // decoding the preset library in prepareToPlay().
+    void setLoadsPresetLibrary (bool shouldLoad) { loadsPresetLibrary = shouldLoad; }
+    
     AudioProcessorValueTreeState tree;
     AudioProcessorValueTreeState::ParameterLayout createParameterLayout(); 
     
+    ParameterSnapshot parameterSnapshot{ tree };
+    
     std::unique_ptr<PresetManager> presetManager;
     PresetManager& getPresetManager() { return *presetManager; };
     
+    // Stands in for the output while a preset is being auditioned.
+    PreviewPlayer previewPlayer;
+    
 
 private:
+    void processSubBlock (juce::AudioBuffer<float>&, int startSample, int numSamples);
+    
+    int bankSelectMsb = 0, bankSelectLsb = 0;
+    bool loadsPresetLibrary = true;
+    std::atomic<StateChunk::Tier> stateCompression { StateChunk::Tier::automatic };
+    StateChunk::WriteHistory stateWriteHistory;
+    
+   #if PPM_REALTIME_SAFETY_CHECKS
+    std::unique_ptr<RealtimeSafety::ValueTreeMutationWatcher> stateMutationWatcher;
+   #endif
+    
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PluginPresetManagerAudioProcessor)
 };
@@ -0,0 +1,428 @@
+/*
+  ==============================================================================
+
+    PresetAuditioner.cpp
+    Created: 19 Oct 2026 6:33:37am
+
+  ==============================================================================
+*/
+
+#include "PresetAuditioner.h"
+#include "PluginProcessor.h"
+
+class PresetAuditioner::RenderJob : public ThreadPoolJob
+{
+public:
+    RenderJob(PresetAuditioner& owner, const String& name, const Parameters::Values& valuesToRender, uint64 hash,
+              std::shared_ptr<const ReferenceClip> clipToRender, int generation, PreviewCallback callbackToUse)
+        : ThreadPoolJob("Preset preview: " + name),
+          auditioner(owner), presetName(name), values(valuesToRender), contentHash(hash),
+          clip(std::move(clipToRender)), clipGeneration(generation), callback(std::move(callbackToUse))
+    {
+    }
+    
+    JobStatus runJob() override
+    {
+        auto& renderer = auditioner.acquireRenderer();
+        const auto preview = render(*renderer.processor, values, *clip);
+        renderer.isInUse = false;
+        
+        if (shouldExit()){
+            return jobHasFinished;
+        }
+        
+        auditioner.storePreview(contentHash, clipGeneration, encode(preview, clip->sampleRate));
+        
+        if (callback != nullptr)
+        {
+            MessageManager::callAsync([callback = callback, presetName = presetName, preview]
+            {
+                callback(presetName, preview);
+            });
+        }
+        return jobHasFinished;
+    }
+    
+    bool isBackgroundRender() const noexcept
+    {
+        return callback == nullptr;
+    }
+    
+    uint64 getHash() const noexcept
+    {
+        return contentHash;
+    }
+    
+private:
+    PresetAuditioner& auditioner;
+    const String presetName;
+    const Parameters::Values values;
+    const uint64 contentHash;
+    const std::shared_ptr<const ReferenceClip> clip;
+    const int clipGeneration;
+    const PreviewCallback callback;
+};
+
+void PreviewPlayer::play(const AudioBuffer<float>& preview)
+{
+    auto newPlayback = std::make_shared<Playback>();
+    newPlayback->buffer = preview;
+    playback.publish(std::move(newPlayback));
+}
+
+void PreviewPlayer::stop()
+{
+    playback.clear();
+}
+
+void PreviewPlayer::renderNextBlock(AudioBuffer<float>& buffer) noexcept
+{
+    const HazardPointer<Playback>::ScopedRead current{ playback };
+    const auto numPreviewChannels = current.get() != nullptr ? current->buffer.getNumChannels() : 0;
+    if (numPreviewChannels > 0)
+    {
+        const auto position = current->position.load();
+        const auto numSamples = jlimit(0, buffer.getNumSamples(), current->buffer.getNumSamples() - position);
+        
+        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+        {
+            buffer.copyFrom(channel, 0, current->buffer, jmin(channel, numPreviewChannels - 1), position, numSamples);
+            buffer.clear(channel, numSamples, buffer.getNumSamples() - numSamples);
+        }
+        
+        current->position = position + numSamples;
+        if (numSamples < buffer.getNumSamples()){
+            playback.compareAndClear(current.get());
+        }
+    }
+}
+
+void PreviewPlayer::setSampleRate(double newSampleRate) noexcept
+{
+    sampleRate = newSampleRate;
+}
+
+double PreviewPlayer::getSampleRate() const noexcept
+{
+    return sampleRate.load();
+}
+
+PresetAuditioner::PresetAuditioner(PresetManager& pm, int numThreads) : presetManager(pm), threadPool(numThreads)
+{
+    // A processor owns timers and listeners, so it has to be created here rather than on a worker.
+    for (int index = 0; index < numThreads; ++index)
+    {
+        auto renderer = std::make_unique<Renderer>();
+        renderer->processor = std::make_unique<PluginPresetManagerAudioProcessor>();
+        renderer->processor->setNonRealtime(true);
+        renderer->processor->setLoadsPresetLibrary(false);
+        renderers.push_back(std::move(renderer));
+    }
+}
+
+PresetAuditioner::~PresetAuditioner()
+{
+    threadPool.removeAllJobs(true, 5000);
+}
+
+void PresetAuditioner::setReferenceClip(const AudioBuffer<float>& clip, double sampleRate)
+{
+    threadPool.removeAllJobs(true, 0);
+    
+    const ScopedLock sl(lock);
+    referenceClip = std::make_shared<const ReferenceClip>(ReferenceClip{ clip, sampleRate });
+    ++clipGeneration;
+    previews.clear();
+    previewOrder.clear();
+    pendingRenders.clear();
+    cachedBytes = 0;
+}
+
+void PresetAuditioner::requestPreview(const String& presetName, PreviewCallback callback)
+{
+    const auto values = presetManager.getPresetValues(presetName);
+    if (!values.has_value()){
+        return;
+    }
+    
+    AudioBuffer<float> preview;
+    if (findPreview(getContentHash(*values), preview))
+    {
+        callback(presetName, preview);
+        return;
+    }
+    
+    queueRender(presetName, *values, std::move(callback));
+}
+
+void PresetAuditioner::renderAround(const StringArray& presetNames, int index)
+{
+    int maxRenders = 0;
+    {
+        const ScopedLock sl(lock);
+        if (referenceClip == nullptr){
+            return;
+        }
+        
+        // Sized as uncompressed 24-bit audio, which FLAC only ever makes smaller.
+        const auto estimatedPreviewBytes = (size_t) jmax(1, referenceClip->buffer.getNumSamples() * referenceClip->buffer.getNumChannels() * 3);
+        maxRenders = (int) jmin((size_t) presetNames.size(), cacheSizeLimit / 2 / estimatedPreviewBytes);
+    }
+    
+    cancelPendingRenders();
+    
+    int numQueued = 0;
+    const auto queueRenderAt = [&](int position)
+    {
+        if (numQueued >= maxRenders || !isPositiveAndBelow(position, presetNames.size())){
+            return;
+        }
+        
+        const auto values = presetManager.getPresetValues(presetNames[position]);
+        if (values.has_value()){
+            queueRender(presetNames[position], *values, nullptr);
+        }
+        ++numQueued;
+    };
+    
+    // Outwards from the selection, alternating below and above it.
+    for (int distance = 0; numQueued < maxRenders && distance < presetNames.size(); ++distance)
+    {
+        queueRenderAt(index + distance);
+        if (distance > 0){
+            queueRenderAt(index - distance);
+        }
+    }
+}
+
+void PresetAuditioner::cancelPendingRenders()
+{
+    struct BackgroundRenders : public ThreadPool::JobSelector
+    {
+        bool isJobSuitable(ThreadPoolJob* job) override
+        {
+            auto* renderJob = dynamic_cast<RenderJob*>(job);
+            if (renderJob == nullptr || !renderJob->isBackgroundRender()){
+                return false;
+            }
+            hashes.push_back(renderJob->getHash());
+            return true;
+        }
+        
+        std::vector<uint64> hashes;
+    };
+    
+    BackgroundRenders backgroundRenders;
+    threadPool.removeAllJobs(false, 0, &backgroundRenders);
+    
+    // Nothing will store these now, so they mustn't keep blocking a later render of the same preset.
+    const ScopedLock sl(lock);
+    for (const auto hash : backgroundRenders.hashes){
+        pendingRenders.erase(hash);
+    }
+}
+
+bool PresetAuditioner::getCachedPreview(const String& presetName, AudioBuffer<float>& preview)
+{
+    const auto values = presetManager.getPresetValues(presetName);
+    return values.has_value() && findPreview(getContentHash(*values), preview);
+}
+
+void PresetAuditioner::setCacheSizeLimit(size_t maxBytes)
+{
+    const ScopedLock sl(lock);
+    cacheSizeLimit = maxBytes;
+}
+
+int PresetAuditioner::getNumPendingRenders() const
+{
+    return threadPool.getNumJobs();
+}
+
+uint64 PresetAuditioner::getContentHash(const Parameters::Values& values)
+{
+    const std::string_view bytes{ reinterpret_cast<const char*>(values.data()), sizeof(values) };
+    return (static_cast<uint64>(Parameters::hash(bytes, Parameters::layoutHash)) << 32)
+         | Parameters::hash(bytes, ~Parameters::layoutHash);
+}
+
+AudioBuffer<float> PresetAuditioner::createReferenceClip(double sampleRate)
+{
+    constexpr std::array<double, 4> noteFrequencies{ 220.0, 261.63, 329.63, 440.0 };
+    const auto noteLength = (int) (sampleRate * 0.5);
+    
+    AudioBuffer<float> clip{ 2, noteLength * (int) noteFrequencies.size() };
+    clip.clear();
+    
+    for (size_t note = 0; note < noteFrequencies.size(); ++note)
+    {
+        auto* const samples = clip.getWritePointer(0, (int) note * noteLength);
+        for (int sample = 0; sample < noteLength; ++sample)
+        {
+            const auto time = sample / sampleRate;
+            const auto phase = MathConstants<double>::twoPi * noteFrequencies[note] * time;
+            const auto envelope = std::exp(-6.0 * time);
+            samples[sample] = (float) (0.3 * envelope * (std::sin(phase) + 0.5 * std::sin(2.0 * phase) + 0.25 * std::sin(3.0 * phase)));
+        }
+    }
+    
+    clip.copyFrom(1, 0, clip, 0, 0, clip.getNumSamples());
+    return clip;
+}
+
+void PresetAuditioner::queueRender(const String& presetName, const Parameters::Values& values, PreviewCallback callback)
+{
+    const auto contentHash = getContentHash(values);
+    std::shared_ptr<const ReferenceClip> clip;
+    int generation = 0;
+    
+    {
+        const ScopedLock sl(lock);
+        if (referenceClip == nullptr)
+        {
+            DBG("Set a reference clip before requesting previews");
+            jassertfalse;
+            return;
+        }
+        
+        // Batch renders skip anything already cached or on its way; explicit requests always get their callback.
+        if (previews.count(contentHash) > 0 || (callback == nullptr && pendingRenders.count(contentHash) > 0)){
+            return;
+        }
+        
+        pendingRenders.insert(contentHash);
+        clip = referenceClip;
+        generation = clipGeneration;
+    }
+    
+    // Someone is waiting on an explicit request, so it goes ahead of any library render still queued.
+    const auto isRequested = callback != nullptr;
+    auto* job = new RenderJob(*this, presetName, values, contentHash, std::move(clip), generation, std::move(callback));
+    threadPool.addJob(job, true);
+    if (isRequested){
+        threadPool.moveJobToFront(job);
+    }
+}
+
+PresetAuditioner::Renderer& PresetAuditioner::acquireRenderer()
+{
+    // There are as many renderers as workers, so one is always free for a running job.
+    for (;;)
+    {
+        for (auto& renderer : renderers)
+        {
+            auto isInUse = false;
+            if (renderer->isInUse.compare_exchange_strong(isInUse, true)){
+                return *renderer;
+            }
+        }
+        Thread::yield();
+    }
+}
+
+void PresetAuditioner::storePreview(uint64 contentHash, int generation, MemoryBlock&& encodedPreview)
+{
+    const ScopedLock sl(lock);
+    pendingRenders.erase(contentHash);
+    
+    if (generation != clipGeneration || encodedPreview.getSize() == 0 || previews.count(contentHash) > 0){
+        return;
+    }
+    
+    cachedBytes += encodedPreview.getSize();
+    previews.emplace(contentHash, std::move(encodedPreview));
+    previewOrder.push_back(contentHash);
+    
+    while (cachedBytes > cacheSizeLimit && previewOrder.size() > 1)
+    {
+        const auto oldest = previews.find(previewOrder.front());
+        cachedBytes -= oldest->second.getSize();
+        previews.erase(oldest);
+        previewOrder.pop_front();
+    }
+}
+
+bool PresetAuditioner::findPreview(uint64 contentHash, AudioBuffer<float>& preview)
+{
+    MemoryBlock encodedPreview;
+    {
+        const ScopedLock sl(lock);
+        const auto cached = previews.find(contentHash);
+        if (cached == previews.end()){
+            return false;
+        }
+        encodedPreview = cached->second;
+    }
+    return decode(encodedPreview, preview);
+}
+
+AudioBuffer<float> PresetAuditioner::render(PluginPresetManagerAudioProcessor& processor, const Parameters::Values& values,
+                                            const ReferenceClip& clip)
+{
+    constexpr int blockSize = 512;
+    
+    const auto numClipChannels = clip.buffer.getNumChannels();
+    const auto numSamples = clip.buffer.getNumSamples();
+    if (numClipChannels == 0 || numSamples == 0){
+        return {};
+    }
+    
+    // The worker is the private instance's audio thread, so the values go in the way that thread applies
+    // them: without gestures or host notifications. Preparing again resets whatever the last render left.
+    processor.setRateAndBufferSizeDetails(clip.sampleRate, blockSize);
+    processor.prepareToPlay(clip.sampleRate, blockSize);
+    processor.getPresetManager().applyParameterValuesFromAudioThread(values);
+    
+    const auto numChannels = jmax(processor.getTotalNumInputChannels(), processor.getTotalNumOutputChannels());
+    AudioBuffer<float> preview{ numChannels, numSamples };
+    for (int channel = 0; channel < numChannels; ++channel){
+        preview.copyFrom(channel, 0, clip.buffer, jmin(channel, numClipChannels - 1), 0, numSamples);
+    }
+    
+    MidiBuffer midiMessages;
+    for (int startSample = 0; startSample < numSamples; startSample += blockSize)
+    {
+        AudioBuffer<float> block{ preview.getArrayOfWritePointers(), numChannels, startSample, jmin(blockSize, numSamples - startSample) };
+        processor.processBlock(block, midiMessages);
+        midiMessages.clear();
+    }
+    
+    processor.releaseResources();
+    return preview;
+}
+
+MemoryBlock PresetAuditioner::encode(const AudioBuffer<float>& preview, double sampleRate)
+{
+    MemoryBlock encodedPreview;
+    if (preview.getNumSamples() == 0){
+        return encodedPreview;
+    }
+    
+    FlacAudioFormat flac;
+    auto stream = std::make_unique<MemoryOutputStream>(encodedPreview, false);
+    std::unique_ptr<AudioFormatWriter> writer{ flac.createWriterFor(stream.get(), sampleRate, (unsigned int) preview.getNumChannels(), 24, {}, 0) };
+    if (writer == nullptr)
+    {
+        jassertfalse;
+        return {};
+    }
+    
+    // The writer owns the stream from here on, and flushes it when it's destroyed.
+    stream.release();
+    writer->writeFromAudioSampleBuffer(preview, 0, preview.getNumSamples());
+    writer.reset();
+    return encodedPreview;
+}
+
+bool PresetAuditioner::decode(const MemoryBlock& encodedPreview, AudioBuffer<float>& preview)
+{
+    FlacAudioFormat flac;
+    std::unique_ptr<AudioFormatReader> reader{ flac.createReaderFor(new MemoryInputStream(encodedPreview, false), true) };
+    if (reader == nullptr){
+        return false;
+    }
+    
+    const auto numSamples = (int) reader->lengthInSamples;
+    preview.setSize((int) reader->numChannels, numSamples);
+    return reader->read(&preview, 0, numSamples, 0, true, true);
+}
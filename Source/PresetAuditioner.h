@@ -0,0 +1,133 @@
+/*
+  ==============================================================================
+
+    PresetAuditioner.h
+    Created: 19 Oct 2026 6:33:37am
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "PresetManager.h"
+#include "HazardPointer.h"
+
+class PluginPresetManagerAudioProcessor;
+
+// Plays a rendered preview in place of the processor's output. Previews are handed to the audio thread
+// without locking or allocating there, and are only ever freed on the message thread.
+class PreviewPlayer
+{
+public:
+    // Message thread. Replaces whatever preview is playing.
+    void play(const AudioBuffer<float>& preview);
+    
+    void stop();
+    
+    // Audio thread: overwrites the block with the next part of the preview, if one is playing.
+    void renderNextBlock(AudioBuffer<float>& buffer) noexcept;
+    
+    // Previews have to be rendered at the rate the processor is running at.
+    void setSampleRate(double newSampleRate) noexcept;
+    
+    double getSampleRate() const noexcept;
+    
+private:
+    struct Playback
+    {
+        AudioBuffer<float> buffer;
+        std::atomic<int> position{ 0 };
+    };
+    
+    HazardPointer<Playback> playback;
+    std::atomic<double> sampleRate{ 44100.0 };
+};
+
+// Renders short previews of presets offline, on worker threads, by running a reference clip through a
+// private processor instance. Previews are kept FLAC-compressed and keyed by a hash of the preset's
+// parameter values, so identical presets share one render.
+//
+// Every worker renders through its own processor, created along with the auditioner on the message thread
+// and reused for every render.
+class PresetAuditioner
+{
+public:
+    PresetAuditioner(PresetManager&, int numThreads = SystemStats::getNumCpus());
+    
+    ~PresetAuditioner();
+    
+    using PreviewCallback = std::function<void(const String& presetName, const AudioBuffer<float>& preview)>;
+    
+    // Replaces the clip previews are rendered from. Previews rendered from the old clip are discarded.
+    void setReferenceClip(const AudioBuffer<float>& clip, double sampleRate);
+    
+    // Calls back on the message thread with the preview, rendering it first if it isn't cached.
+    void requestPreview(const String& presetName, PreviewCallback callback);
+    
+    // Queues renders of the presets around the one at the given index, nearest first, but no more than
+    // half the cache can hold, so that pre-rendering never evicts what was just played. Renders queued
+    // around an earlier selection that haven't started yet are dropped first.
+    void renderAround(const StringArray& presetNames, int index);
+    
+    // Drops every queued render nobody is waiting on. Renders already running are left to finish.
+    void cancelPendingRenders();
+    
+    bool getCachedPreview(const String& presetName, AudioBuffer<float>& preview);
+    
+    void setCacheSizeLimit(size_t maxBytes);
+    
+    int getNumPendingRenders() const;
+    
+    static uint64 getContentHash(const Parameters::Values& values);
+    
+    // A couple of seconds of plucked notes, for previewing without a clip of the user's own.
+    static AudioBuffer<float> createReferenceClip(double sampleRate);
+    
+private:
+    class RenderJob;
+    
+    struct Renderer
+    {
+        std::unique_ptr<PluginPresetManagerAudioProcessor> processor;
+        std::atomic<bool> isInUse{ false };
+    };
+    
+    struct ReferenceClip
+    {
+        AudioBuffer<float> buffer;
+        double sampleRate = 44100.0;
+    };
+    
+    void queueRender(const String& presetName, const Parameters::Values& values, PreviewCallback callback);
+    
+    void storePreview(uint64 contentHash, int clipGeneration, MemoryBlock&& encodedPreview);
+    
+    bool findPreview(uint64 contentHash, AudioBuffer<float>& preview);
+    
+    Renderer& acquireRenderer();
+    
+    static AudioBuffer<float> render(PluginPresetManagerAudioProcessor& processor, const Parameters::Values& values,
+                                     const ReferenceClip& clip);
+    
+    static MemoryBlock encode(const AudioBuffer<float>& preview, double sampleRate);
+    
+    static bool decode(const MemoryBlock& encodedPreview, AudioBuffer<float>& preview);
+    
+    PresetManager& presetManager;
+    
+    // Declared before the pool, so that they outlive its threads.
+    std::vector<std::unique_ptr<Renderer>> renderers;
+    ThreadPool threadPool;
+    
+    CriticalSection lock;
+    std::shared_ptr<const ReferenceClip> referenceClip;
+    int clipGeneration = 0;
+    std::map<uint64, MemoryBlock> previews;
+    std::deque<uint64> previewOrder;
+    std::set<uint64> pendingRenders;
+    size_t cachedBytes = 0;
+    size_t cacheSizeLimit = 256 * 1024 * 1024;
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PresetAuditioner);
+};
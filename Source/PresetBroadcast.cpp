@@ -0,0 +1,191 @@
+/*
+  ==============================================================================
+
+    PresetBroadcast.cpp
+    Created: 19 Oct 2026 6:50:21am
+
+  ==============================================================================
+*/
+
+#include "PresetBroadcast.h"
+
+#if PPM_SYSTEM_WIDE_PRESET_BROADCAST && (JUCE_LINUX || JUCE_MAC || JUCE_BSD)
+ #include <fcntl.h>
+ #include <sys/mman.h>
+ #include <sys/stat.h>
+ #include <unistd.h>
+ #define PPM_HAS_SHARED_MEMORY_RING 1
+#else
+ #define PPM_HAS_SHARED_MEMORY_RING 0
+#endif
+
+// Maps the ring into a named POSIX shared memory object. The object is deliberately never unlinked,
+// since other processes may still be using it; it is small, and the next session reuses it. Each user
+// gets their own object, readable and writable only by them, so other users can't see or inject presets.
+class PresetBroadcast::SharedMemoryRing
+{
+public:
+    SharedMemoryRing()
+    {
+       #if PPM_HAS_SHARED_MEMORY_RING
+        const auto userId = geteuid();
+        const auto name = "/" + String(ProjectInfo::projectName).removeCharacters(" /") + "-presets-" + String((int64) userId);
+        const auto fd = shm_open(name.toRawUTF8(), O_RDWR | O_CREAT, 0600);
+        if (fd < 0){
+            return;
+        }
+        
+        // An object someone else created under this user's name, or opened up to others, isn't used.
+        // Whichever process gets here first sizes the object. Freshly truncated memory reads as zero,
+        // which is a valid empty ring.
+        struct stat status;
+        const auto isSized = fstat(fd, &status) == 0
+                          && status.st_uid == userId
+                          && (status.st_mode & (S_IRWXG | S_IRWXO)) == 0
+                          && (status.st_size == (off_t) sizeof(Ring)
+                              || (status.st_size == 0 && ftruncate(fd, (off_t) sizeof(Ring)) == 0));
+        
+        if (isSized)
+        {
+            auto* const address = mmap(nullptr, sizeof(Ring), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (address != MAP_FAILED){
+                mapped = static_cast<Ring*>(address);
+            }
+        }
+        close(fd);
+       #endif
+    }
+    
+    ~SharedMemoryRing()
+    {
+       #if PPM_HAS_SHARED_MEMORY_RING
+        if (mapped != nullptr){
+            munmap(mapped, sizeof(Ring));
+        }
+       #endif
+    }
+    
+    Ring* get() const noexcept { return mapped; }
+    
+private:
+    Ring* mapped = nullptr;
+};
+
+PresetBroadcast::PresetBroadcast() : instanceId(static_cast<uint64>(Uuid().hash()) | 1)
+{
+   #if PPM_HAS_SHARED_MEMORY_RING
+    sharedMemoryRing = std::make_unique<SharedMemoryRing>();
+    if (auto* sharedRing = sharedMemoryRing->get())
+    {
+        // A ring created by an incompatible build is left alone, and this instance stays in-process.
+        auto format = 0u;
+        if (sharedRing->format.compare_exchange_strong(format, ringFormat) || format == ringFormat){
+            ring = sharedRing;
+        }
+    }
+   #endif
+    
+    if (ring == nullptr){
+        ring = &inProcessRing->ring;
+    }
+    
+    // Only presets published from now on are received.
+    lastReceivedId = ring->head.load(std::memory_order_acquire);
+}
+
+PresetBroadcast::~PresetBroadcast()
+{
+}
+
+void PresetBroadcast::publish(const String& presetName, const Parameters::Values& values)
+{
+    const auto id = ring->head.fetch_add(1, std::memory_order_acq_rel) + 1;
+    auto& slot = ring->slots[(id - 1) % capacity];
+    
+    slot.sequence.store(2 * id - 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    
+    slot.sourceId.store(instanceId, std::memory_order_relaxed);
+    slot.layoutHash.store(Parameters::layoutHash, std::memory_order_relaxed);
+    for (int index = 0; index < Parameters::numParameters; ++index){
+        slot.values[index].store(values[(size_t) index], std::memory_order_relaxed);
+    }
+    
+    const auto* utf8 = presetName.toRawUTF8();
+    auto nameLength = jmin((int) presetName.getNumBytesAsUTF8(), maxNameLength - 1);
+    
+    // Long names are cut at a character boundary.
+    while (nameLength > 0 && (utf8[nameLength] & 0xc0) == 0x80){
+        --nameLength;
+    }
+    
+    for (int index = 0; index < maxNameLength; ++index){
+        slot.name[index].store(index < nameLength ? utf8[index] : '\0', std::memory_order_relaxed);
+    }
+    
+    slot.sequence.store(2 * id, std::memory_order_release);
+}
+
+uint64 PresetBroadcast::receive(Parameters::Values& values) noexcept
+{
+    const auto id = ring->head.load(std::memory_order_acquire);
+    if (id == lastReceivedId){
+        return 0;
+    }
+    
+    // Only the newest broadcast matters. If it is still being written, it is picked up next block.
+    const auto& slot = ring->slots[(id - 1) % capacity];
+    if (slot.sequence.load(std::memory_order_acquire) != 2 * id){
+        return 0;
+    }
+    
+    const auto sourceId = slot.sourceId.load(std::memory_order_relaxed);
+    const auto layoutHash = slot.layoutHash.load(std::memory_order_relaxed);
+    Parameters::Values received;
+    for (int index = 0; index < Parameters::numParameters; ++index){
+        received[(size_t) index] = slot.values[index].load(std::memory_order_relaxed);
+    }
+    
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.sequence.load(std::memory_order_relaxed) != 2 * id){
+        return 0;
+    }
+    
+    lastReceivedId = id;
+    if (sourceId == instanceId || layoutHash != Parameters::layoutHash){
+        return 0;
+    }
+    
+    values = received;
+    return id;
+}
+
+String PresetBroadcast::getPresetName(uint64 broadcastId) const
+{
+    if (broadcastId == 0){
+        return {};
+    }
+    
+    const auto& slot = ring->slots[(broadcastId - 1) % capacity];
+    if (slot.sequence.load(std::memory_order_acquire) != 2 * broadcastId){
+        return {};
+    }
+    
+    char name[maxNameLength];
+    for (int index = 0; index < maxNameLength; ++index){
+        name[index] = slot.name[index].load(std::memory_order_relaxed);
+    }
+    
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.sequence.load(std::memory_order_relaxed) != 2 * broadcastId){
+        return {};
+    }
+    
+    name[maxNameLength - 1] = '\0';
+    return String::fromUTF8(name);
+}
+
+bool PresetBroadcast::isSharedAcrossProcesses() const noexcept
+{
+    return sharedMemoryRing != nullptr && ring == sharedMemoryRing->get();
+}
@@ -0,0 +1,87 @@
+/*
+  ==============================================================================
+
+    PresetBroadcast.h
+    Created: 19 Oct 2026 6:50:21am
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Parameters.h"
+
+// Broadcasts decoded presets between plugin instances through a lock-free ring of seqlock-protected
+// slots. Every instance in the process shares one ring; with PPM_SYSTEM_WIDE_PRESET_BROADCAST=1 the ring
+// lives in POSIX shared memory instead, so instances in other processes (e.g. sandboxed hosts) run by the
+// same user share it too. Publishing decodes once and writes one slot; receivers copy the newest slot on
+// their audio thread, and ignore slots written by themselves or by a build with a different parameter
+// layout.
+#ifndef PPM_SYSTEM_WIDE_PRESET_BROADCAST
+ #define PPM_SYSTEM_WIDE_PRESET_BROADCAST 0
+#endif
+
+class PresetBroadcast
+{
+public:
+    PresetBroadcast();
+    
+    ~PresetBroadcast();
+    
+    // Any thread other than the audio thread.
+    void publish(const String& presetName, const Parameters::Values& values);
+    
+    // Audio thread. Returns the id of the newest broadcast from another instance if one has arrived since
+    // the last call, or 0 if nothing new has.
+    uint64 receive(Parameters::Values& values) noexcept;
+    
+    // The name a broadcast was published with. Empty if it has since been overwritten.
+    String getPresetName(uint64 broadcastId) const;
+    
+    bool isSharedAcrossProcesses() const noexcept;
+    
+    static constexpr int maxParameters = 256;
+    static constexpr int maxNameLength = 64;
+    static constexpr int capacity = 16;
+    
+private:
+    struct Slot
+    {
+        // 2 * id - 1 while broadcast id is being written, 2 * id once it is complete.
+        std::atomic<uint64> sequence;
+        std::atomic<uint64> sourceId;
+        std::atomic<uint32> layoutHash;
+        std::atomic<float> values[maxParameters];
+        std::atomic<char> name[maxNameLength];
+    };
+    
+    // Plain atomics only, so that zero-filled shared memory is a valid empty ring.
+    struct Ring
+    {
+        std::atomic<uint32> format;
+        std::atomic<uint64> head;
+        Slot slots[capacity];
+    };
+    
+    struct InProcessRing
+    {
+        Ring ring{};
+    };
+    
+    class SharedMemoryRing;
+    
+    static_assert(Parameters::numParameters <= maxParameters);
+    static_assert(std::atomic<uint64>::is_always_lock_free && std::atomic<float>::is_always_lock_free);
+    
+    static constexpr uint32 ringFormat = 1;
+    
+    SharedResourcePointer<InProcessRing> inProcessRing;
+    std::unique_ptr<SharedMemoryRing> sharedMemoryRing;
+    Ring* ring = nullptr;
+    
+    const uint64 instanceId;
+    uint64 lastReceivedId = 0;
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PresetBroadcast);
+};
@@ -0,0 +1,559 @@
+/*
+  ==============================================================================
+
+    PresetCatalogue.cpp
+    Created: 19 Oct 2026 6:39:09am
+
+  ==============================================================================
+*/
+
+#include "PresetCatalogue.h"
+
+int PresetCatalogue::Snapshot::indexOf(const String& presetName) const
+{
+    const auto found = std::lower_bound(entries.begin(), entries.end(), presetName, [](const Entry& entry, const String& name)
+    {
+        return compareNames(entry.name, name) < 0;
+    });
+    
+    if (found == entries.end() || found->name != presetName){
+        return -1;
+    }
+    return (int) std::distance(entries.begin(), found);
+}
+
+PresetCatalogue::PresetCatalogue(const File& directoryToScan, const String& fileExtension, const File& catalogueFileToUse)
+    : Thread("Preset catalogue"),
+      directory(directoryToScan),
+      extension(fileExtension),
+      catalogueFile(catalogueFileToUse != File() ? catalogueFileToUse : getDefaultCatalogueFile(directoryToScan, fileExtension))
+{
+}
+
+PresetCatalogue::~PresetCatalogue()
+{
+    stopScanning();
+}
+
+std::shared_ptr<const PresetCatalogue::Snapshot> PresetCatalogue::getSnapshot()
+{
+    if (needsScan() || hasDirectoryChanged()){
+        scan();
+    }
+    return getCachedSnapshot();
+}
+
+std::shared_ptr<const PresetCatalogue::Snapshot> PresetCatalogue::getCachedSnapshot() const
+{
+    const SpinLock::ScopedLockType sl(snapshotLock);
+    return snapshot;
+}
+
+void PresetCatalogue::invalidate()
+{
+    isDirty = true;
+}
+
+void PresetCatalogue::scanInBackground()
+{
+    if (needsScan() && !isThreadRunning()){
+        startThread();
+    }
+}
+
+void PresetCatalogue::stopScanning()
+{
+    stopThread(5000);
+}
+
+bool PresetCatalogue::needsScan() const
+{
+    return isDirty.load() || getCachedSnapshot() == nullptr;
+}
+
+int PresetCatalogue::compareNames(const String& first, const String& second)
+{
+    const auto naturalOrder = first.compareNatural(second);
+    return naturalOrder != 0 ? naturalOrder : first.compare(second);
+}
+
+File PresetCatalogue::getDefaultCatalogueFile(const File& directoryToScan, const String& fileExtension)
+{
+    return directoryToScan.getChildFile("." + fileExtension + "catalogue");
+}
+
+int PresetCatalogue::readStoredEntryCount(const File& catalogueFileToRead)
+{
+    FileInputStream input{ catalogueFileToRead };
+    if (input.failedToOpen()
+        || input.readInt() != catalogueMagic
+        || input.readInt() != catalogueFormatVersion
+        || (uint32) input.readInt() != Parameters::layoutHash
+        || input.readInt() != Parameters::numParameters)
+    {
+        return 0;
+    }
+    
+    input.setPosition(directoryModifiedOffset + 8);
+    return jmax(0, input.readInt());
+}
+
+uint64 PresetCatalogue::hashContent(const void* data, size_t numBytes)
+{
+    const std::string_view bytes{ static_cast<const char*>(data), numBytes };
+    return (static_cast<uint64>(Parameters::hash(bytes, 0)) << 32) | Parameters::hash(bytes, 0x9e3779b9u);
+}
+
+void PresetCatalogue::run()
+{
+    while (!threadShouldExit() && needsScan()){
+        scan();
+    }
+}
+
+bool PresetCatalogue::hasDirectoryChanged()
+{
+    const auto now = Time::getMillisecondCounter();
+    if (now - lastValidationTime.load() < validationIntervalMs){
+        return false;
+    }
+    lastValidationTime = now;
+    
+    const auto current = getCachedSnapshot();
+    return current != nullptr && current->directoryModified != directory.getLastModificationTime();
+}
+
+void PresetCatalogue::scan()
+{
+    // A scan already running on another thread leaves nothing to do once it finishes.
+    const ScopedLock sl(scanLock);
+    const auto wasInvalidated = isDirty.exchange(false);
+    const auto directoryModified = directory.getLastModificationTime();
+    
+    std::shared_ptr<const Snapshot> previous = getCachedSnapshot();
+    if (previous == nullptr){
+        previous = readCatalogueFile();
+    }
+    
+    // Nothing was added, removed or renamed, so what we already have is still accurate.
+    if (!wasInvalidated && previous != nullptr && previous->directoryModified == directoryModified)
+    {
+        if (!pendingMetadata.empty())
+        {
+            auto next = std::make_shared<Snapshot>(*previous);
+            applyPendingMetadata(*next);
+            writeCatalogueFile(*next, next->directoryModified);
+            publish(std::move(next));
+        }
+        else if (previous != getCachedSnapshot()){
+            publish(previous);
+        }
+        return;
+    }
+    
+    auto next = std::make_shared<Snapshot>();
+    next->directoryModified = directoryModified;
+    
+    for (const auto& file : directory.findChildFiles(File::TypesOfFileToFind::findFiles, false, "*." + extension))
+    {
+        Entry entry;
+        entry.name = file.getFileNameWithoutExtension();
+        entry.relativePath = file.getRelativePathFrom(directory);
+        entry.file = file;
+        entry.lastModified = file.getLastModificationTime();
+        entry.size = file.getSize();
+        
+        const auto previousIndex = previous != nullptr ? previous->indexOf(entry.name) : -1;
+        if (previousIndex >= 0)
+        {
+            const auto& previousEntry = previous->entries[(size_t) previousIndex];
+            if (previousEntry.lastModified == entry.lastModified && previousEntry.size == entry.size)
+            {
+                next->entries.push_back(previousEntry);
+                continue;
+            }
+        }
+        
+        readEntry(entry);
+        next->entries.push_back(std::move(entry));
+    }
+    
+    std::sort(next->entries.begin(), next->entries.end(), [](const Entry& first, const Entry& second)
+    {
+        return compareNames(first.name, second.name) < 0;
+    });
+    
+    // Bases may have changed even where the derived file hasn't, so everything is resolved again.
+    resolveAll(*next);
+    applyPendingMetadata(*next);
+    
+    writeCatalogueFile(*next, directoryModified);
+    publish(std::move(next));
+}
+
+void PresetCatalogue::publish(std::shared_ptr<const Snapshot> newSnapshot)
+{
+    {
+        const SpinLock::ScopedLockType sl(snapshotLock);
+        snapshot = std::move(newSnapshot);
+    }
+    lastValidationTime = Time::getMillisecondCounter();
+    
+    if (onChange != nullptr){
+        onChange();
+    }
+}
+
+void PresetCatalogue::readEntry(Entry& entry) const
+{
+    MemoryBlock content;
+    if (!entry.file.loadFileAsData(content))
+    {
+        DBG("Could not read preset " + entry.file.getFullPathName());
+        return;
+    }
+    
+    if (!decodeEntry(entry, content)){
+        DBG("Could not parse preset " + entry.file.getFullPathName());
+    }
+}
+
+bool PresetCatalogue::decodeEntry(Entry& entry, const MemoryBlock& content)
+{
+    entry.contentHash = hashContent(content.getData(), content.getSize());
+    
+    const auto xmlState = XmlDocument::parse(content.toString());
+    if (xmlState == nullptr){
+        return false;
+    }
+    
+    for (int index = 0; index < xmlState->getNumAttributes(); ++index)
+    {
+        const auto& attributeName = xmlState->getAttributeName(index);
+        if (attributeName == "basePreset"){
+            entry.basePresetName = xmlState->getAttributeValue(index);
+        } else if (attributeName != "presetName"){
+            entry.metadata.set(attributeName, xmlState->getAttributeValue(index));
+        }
+    }
+    
+    auto hasParameters = false;
+    for (auto* parameterElement : xmlState->getChildIterator())
+    {
+        const auto index = Parameters::getIndex(parameterElement->getStringAttribute("id"));
+        if (index >= 0)
+        {
+            entry.storedValues[(size_t) index] = (float) parameterElement->getDoubleAttribute("value");
+            entry.hasStoredValue[(size_t) index] = true;
+            hasParameters = true;
+        }
+    }
+    
+    // A derived preset that matches its base exactly stores no parameters at all.
+    return hasParameters || entry.basePresetName.isNotEmpty();
+}
+
+void PresetCatalogue::addEntries(std::vector<Entry> newEntries)
+{
+    const ScopedLock sl(scanLock);
+    
+    // Without a snapshot to add to, the next scan will read these from disk anyway.
+    const auto previous = getCachedSnapshot();
+    if (previous == nullptr || isDirty.load()){
+        return;
+    }
+    
+    std::sort(newEntries.begin(), newEntries.end(), [](const Entry& first, const Entry& second)
+    {
+        return compareNames(first.name, second.name) < 0;
+    });
+    
+    // The directory time is left as it was, so the next validation still rescans. That only lists the
+    // directory: these entries match their files' size and modification time and are reused as they are.
+    auto next = std::make_shared<Snapshot>();
+    next->directoryModified = previous->directoryModified;
+    next->entries.reserve(previous->entries.size() + newEntries.size());
+    
+    auto existing = previous->entries.begin();
+    for (auto& entry : newEntries)
+    {
+        while (existing != previous->entries.end() && compareNames(existing->name, entry.name) < 0){
+            next->entries.push_back(*existing++);
+        }
+        if (existing != previous->entries.end() && existing->name == entry.name){
+            ++existing;
+        }
+        if (next->entries.empty() || next->entries.back().name != entry.name){
+            next->entries.push_back(std::move(entry));
+        }
+    }
+    next->entries.insert(next->entries.end(), existing, previous->entries.end());
+    
+    resolveAll(*next);
+    publish(std::move(next));
+}
+
+void PresetCatalogue::setMetadata(const String& key, const std::map<String, String>& valuesByName)
+{
+    const ScopedLock sl(scanLock);
+    
+    // Queued rather than dropped: the scan that brings the catalogue up to date applies them.
+    auto& pendingValues = pendingMetadata[key];
+    for (const auto& [name, value] : valuesByName){
+        pendingValues[name] = value;
+    }
+    
+    const auto previous = getCachedSnapshot();
+    if (previous == nullptr || isDirty.load()){
+        return;
+    }
+    
+    auto next = std::make_shared<Snapshot>(*previous);
+    applyPendingMetadata(*next);
+    
+    writeCatalogueFile(*next, next->directoryModified);
+    publish(std::move(next));
+}
+
+void PresetCatalogue::applyPendingMetadata(Snapshot& snapshotToUpdate)
+{
+    for (const auto& [key, valuesByName] : pendingMetadata)
+    {
+        for (auto& entry : snapshotToUpdate.entries)
+        {
+            const auto found = valuesByName.find(entry.name);
+            if (found != valuesByName.end()){
+                entry.metadata.set(key, found->second);
+            }
+        }
+    }
+    pendingMetadata.clear();
+}
+
+void PresetCatalogue::resolveAll(Snapshot& snapshotToResolve)
+{
+    std::vector<bool> isResolved(snapshotToResolve.entries.size(), false);
+    for (size_t index = 0; index < snapshotToResolve.entries.size(); ++index){
+        resolveEntry(snapshotToResolve, index, isResolved, 0);
+    }
+    
+    snapshotToResolve.names.clearQuick();
+    snapshotToResolve.names.ensureStorageAllocated((int) snapshotToResolve.entries.size());
+    for (const auto& entry : snapshotToResolve.entries){
+        snapshotToResolve.names.add(entry.name);
+    }
+}
+
+void PresetCatalogue::resolveEntry(Snapshot& snapshotToResolve, size_t index, std::vector<bool>& isResolved, int depth)
+{
+    if (isResolved[index]){
+        return;
+    }
+    
+    // Marked before recursing, so a cycle of bases stops here instead of recursing forever.
+    isResolved[index] = true;
+    
+    auto& entry = snapshotToResolve.entries[index];
+    const auto baseIndex = entry.basePresetName.isNotEmpty() ? snapshotToResolve.indexOf(entry.basePresetName) : -1;
+    
+    if (baseIndex >= 0 && depth < maxDerivationDepth)
+    {
+        resolveEntry(snapshotToResolve, (size_t) baseIndex, isResolved, depth + 1);
+        entry.values = snapshotToResolve.entries[(size_t) baseIndex].values;
+    }
+    else
+    {
+        entry.values = Parameters::getDefaultValues();
+    }
+    
+    for (size_t parameter = 0; parameter < entry.values.size(); ++parameter)
+    {
+        if (entry.hasStoredValue[parameter]){
+            entry.values[parameter] = entry.storedValues[parameter];
+        }
+    }
+}
+
+std::shared_ptr<PresetCatalogue::Snapshot> PresetCatalogue::readCatalogueFile() const
+{
+    MemoryMappedFile mappedFile{ catalogueFile, MemoryMappedFile::readOnly };
+    if (mappedFile.getData() == nullptr){
+        return nullptr;
+    }
+    
+    MemoryInputStream input{ mappedFile.getData(), mappedFile.getSize(), false };
+    
+    // Written by another version or for another parameter layout: rebuild it from scratch.
+    if (input.readInt() != catalogueMagic
+        || input.readInt() != catalogueFormatVersion
+        || (uint32) input.readInt() != Parameters::layoutHash
+        || input.readInt() != Parameters::numParameters)
+    {
+        return nullptr;
+    }
+    
+    // Cut off in the header, the count would read as 0 and the sidecar would pass for an empty directory.
+    if (input.getNumBytesRemaining() < 8 + 4){
+        return nullptr;
+    }
+    
+    auto loaded = std::make_shared<Snapshot>();
+    loaded->directoryModified = Time(input.readInt64());
+    
+    // Counts are checked against what's left in the file before anything is sized from them, so that a
+    // corrupt sidecar is rebuilt rather than trusted. Every entry takes at least its three string
+    // terminators, three int64s, a flag and a value per parameter, and its metadata count.
+    constexpr int64 minEntryBytes = 3 + 3 * 8 + Parameters::numParameters * 5 + 4;
+    const auto numEntries = input.readInt();
+    if (numEntries < 0 || numEntries > input.getNumBytesRemaining() / minEntryBytes){
+        return nullptr;
+    }
+    loaded->entries.reserve((size_t) numEntries);
+    
+    // Reads past the end of the mapping return zeros rather than failing, so a truncated sidecar would
+    // otherwise load its last entries cut off or zeroed. A string is only complete if its own terminator
+    // was read, and fixed-size fields are only read if they're all there.
+    const auto* const data = static_cast<const char*>(mappedFile.getData());
+    const auto readCompleteString = [&input, data](String& destination)
+    {
+        const auto start = input.getPosition();
+        destination = input.readString();
+        return input.getPosition() > start && data[input.getPosition() - 1] == 0;
+    };
+    
+    for (int entryIndex = 0; entryIndex < numEntries; ++entryIndex)
+    {
+        Entry entry;
+        if (!readCompleteString(entry.name) || !readCompleteString(entry.relativePath)){
+            return nullptr;
+        }
+        
+        // Presets are only ever listed straight from the directory, so a path that leads anywhere else
+        // means the sidecar is damaged or was tampered with.
+        const auto pathComponents = StringArray::fromTokens(entry.relativePath, "/\\", "");
+        entry.file = directory.getChildFile(entry.relativePath);
+        if (entry.relativePath.isEmpty()
+            || File::isAbsolutePath(entry.relativePath)
+            || pathComponents.contains("..")
+            || entry.file.getParentDirectory() != directory)
+        {
+            return nullptr;
+        }
+        
+        if (input.getNumBytesRemaining() < 3 * 8){
+            return nullptr;
+        }
+        entry.lastModified = Time(input.readInt64());
+        entry.size = input.readInt64();
+        entry.contentHash = (uint64) input.readInt64();
+        
+        if (!readCompleteString(entry.basePresetName) || input.getNumBytesRemaining() < Parameters::numParameters * 5 + 4){
+            return nullptr;
+        }
+        
+        for (size_t parameter = 0; parameter < entry.storedValues.size(); ++parameter)
+        {
+            entry.hasStoredValue[parameter] = input.readBool();
+            entry.storedValues[parameter] = input.readFloat();
+        }
+        
+        // Each key and value takes at least its terminator.
+        const auto numMetadata = input.readInt();
+        if (numMetadata < 0 || numMetadata > input.getNumBytesRemaining() / 2){
+            return nullptr;
+        }
+        
+        for (int metadataIndex = 0; metadataIndex < numMetadata; ++metadataIndex)
+        {
+            String key;
+            String value;
+            if (!readCompleteString(key) || !readCompleteString(value)){
+                return nullptr;
+            }
+            entry.metadata.set(key, value);
+        }
+        
+        loaded->entries.push_back(std::move(entry));
+    }
+    
+    resolveAll(*loaded);
+    return loaded;
+}
+
+void PresetCatalogue::writeCatalogueFile(const Snapshot& snapshotToWrite, Time directoryModifiedBeforeScan) const
+{
+    const auto isInDirectory = catalogueFile.getParentDirectory() == directory;
+    if (!directory.isDirectory() || (!isInDirectory && catalogueFile.getParentDirectory().createDirectory().failed())){
+        return;
+    }
+    
+    MemoryOutputStream output;
+    output.writeInt(catalogueMagic);
+    output.writeInt(catalogueFormatVersion);
+    output.writeInt((int) Parameters::layoutHash);
+    output.writeInt(Parameters::numParameters);
+    jassert(output.getPosition() == (uint64) directoryModifiedOffset);
+    output.writeInt64(directoryModifiedBeforeScan.toMilliseconds());
+    output.writeInt((int) snapshotToWrite.entries.size());
+    
+    for (const auto& entry : snapshotToWrite.entries)
+    {
+        output.writeString(entry.name);
+        output.writeString(entry.relativePath);
+        output.writeInt64(entry.lastModified.toMilliseconds());
+        output.writeInt64(entry.size);
+        output.writeInt64((int64) entry.contentHash);
+        output.writeString(entry.basePresetName);
+        
+        for (size_t parameter = 0; parameter < entry.storedValues.size(); ++parameter)
+        {
+            output.writeBool(entry.hasStoredValue[parameter]);
+            output.writeFloat(entry.storedValues[parameter]);
+        }
+        
+        const auto& keys = entry.metadata.getAllKeys();
+        const auto& values = entry.metadata.getAllValues();
+        output.writeInt(keys.size());
+        for (int metadataIndex = 0; metadataIndex < keys.size(); ++metadataIndex)
+        {
+            output.writeString(keys[metadataIndex]);
+            output.writeString(values[metadataIndex]);
+        }
+    }
+    
+    // Other instances may have the sidecar memory-mapped, and truncating it under them would crash them.
+    // So the new one is written next to it and renamed over it, which leaves their mapping of the old
+    // file intact.
+    const auto directoryModifiedBeforeWrite = directory.getLastModificationTime();
+    TemporaryFile temporaryFile{ catalogueFile };
+    {
+        FileOutputStream stream{ temporaryFile.getFile() };
+        if (stream.failedToOpen()){
+            return;
+        }
+        
+        stream.write(output.getData(), output.getDataSize());
+        stream.flush();
+        if (stream.getStatus().failed()){
+            return;
+        }
+    }
+    
+    if (!temporaryFile.overwriteTargetFileWithTemporary()){
+        return;
+    }
+    
+    // Replacing the sidecar moved the directory's time itself. If nothing else had moved it since the
+    // scan, record the new time, patched in place, as that neither resizes the file nor moves the time
+    // again. Otherwise keep the time from before the scan, so that anything changed while scanning is
+    // picked up next time.
+    if (isInDirectory && directoryModifiedBeforeWrite == directoryModifiedBeforeScan)
+    {
+        FileOutputStream stream{ catalogueFile };
+        if (!stream.failedToOpen() && stream.setPosition(directoryModifiedOffset))
+        {
+            stream.writeInt64(directory.getLastModificationTime().toMilliseconds());
+            stream.flush();
+        }
+    }
+}
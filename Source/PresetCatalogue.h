@@ -0,0 +1,144 @@
+/*
+  ==============================================================================
+
+    PresetCatalogue.h
+    Created: 19 Oct 2026 6:39:09am
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Parameters.h"
+
+// An index of the presets in one directory, with every preset already decoded and derived presets
+// resolved against their bases. It is built on first use, either on a background thread or on the
+// caller's, and rescans re-read only files whose size or modification time has changed.
+//
+// The index is persisted to a sidecar file in the directory and memory-mapped on the next start. If the
+// directory's modification time still matches, the sidecar is used as-is without listing or reading a
+// single preset file; otherwise it seeds the rescan so that only changed entries are re-read.
+class PresetCatalogue : private Thread
+{
+public:
+    struct Entry
+    {
+        String name;
+        String relativePath;
+        File file;
+        Time lastModified;
+        int64 size = 0;
+        uint64 contentHash = 0;
+        int layer = 0;
+        String basePresetName;
+        StringPairArray metadata;
+        
+        // What the file itself stores. Derived presets only store the values that differ from their base.
+        Parameters::Values storedValues = Parameters::getDefaultValues();
+        std::array<bool, Parameters::numParameters> hasStoredValue{};
+        
+        // The full values, resolved against the base preset.
+        Parameters::Values values = Parameters::getDefaultValues();
+    };
+    
+    // Immutable once published, so it can be shared with other threads and kept alive while in use.
+    struct Snapshot
+    {
+        std::vector<Entry> entries;
+        StringArray names;
+        Time directoryModified;
+        
+        int indexOf(const String& presetName) const;
+    };
+    
+    // The sidecar is kept in the directory itself unless another file is given, e.g. for a directory the
+    // user can't write to.
+    PresetCatalogue(const File& directory, const String& extension, const File& catalogueFile = {});
+    
+    ~PresetCatalogue() override;
+    
+    // Returns an up-to-date catalogue, scanning on the calling thread if needed. The directory's
+    // modification time is checked at most every few hundred milliseconds.
+    std::shared_ptr<const Snapshot> getSnapshot();
+    
+    // Returns whatever was built last without touching the disk. Null until the first scan completes.
+    std::shared_ptr<const Snapshot> getCachedSnapshot() const;
+    
+    // Marks the catalogue as out of date, so the next request rescans.
+    void invalidate();
+    
+    void scanInBackground();
+    
+    // Waits for a background scan in progress to finish.
+    void stopScanning();
+    
+    bool needsScan() const;
+    
+    // Called on the scanning thread whenever a new snapshot is published.
+    std::function<void()> onChange;
+    
+    static int compareNames(const String& first, const String& second);
+    
+    static uint64 hashContent(const void* data, size_t numBytes);
+    
+    // Fills in an entry from a preset file's content. Returns false if it isn't a valid preset.
+    static bool decodeEntry(Entry& entry, const MemoryBlock& content);
+    
+    // Publishes entries that were decoded elsewhere, e.g. while importing, without reading their files.
+    // Entries replace any existing ones with the same name.
+    void addEntries(std::vector<Entry> newEntries);
+    
+    // Sets one metadata value on the named entries, and keeps it in the sidecar file across sessions.
+    // While the catalogue is out of date the values are queued, and applied by the next scan.
+    void setMetadata(const String& key, const std::map<String, String>& valuesByName);
+    
+    // Resolves every derived entry against its base and rebuilds the name list. Entries must be sorted.
+    static void resolveAll(Snapshot& snapshot);
+    
+    // Where the sidecar goes when the constructor isn't given one.
+    static File getDefaultCatalogueFile(const File& directory, const String& extension);
+    
+    // Reads only the entry count from a sidecar's header, without validating or loading the entries.
+    // Returns 0 if there's no usable sidecar.
+    static int readStoredEntryCount(const File& catalogueFile);
+    
+private:
+    void run() override;
+    
+    void scan();
+    
+    void publish(std::shared_ptr<const Snapshot> newSnapshot);
+    
+    // Call with the scan lock held.
+    void applyPendingMetadata(Snapshot& snapshotToUpdate);
+    
+    bool hasDirectoryChanged();
+    
+    void readEntry(Entry& entry) const;
+    
+    static void resolveEntry(Snapshot& snapshot, size_t index, std::vector<bool>& isResolved, int depth);
+    
+    std::shared_ptr<Snapshot> readCatalogueFile() const;
+    
+    void writeCatalogueFile(const Snapshot& snapshotToWrite, Time directoryModifiedBeforeScan) const;
+    
+    static constexpr int maxDerivationDepth = 8;
+    static constexpr int catalogueMagic = 0x434d5050;
+    static constexpr int catalogueFormatVersion = 1;
+    static constexpr int64 directoryModifiedOffset = 16;
+    static constexpr uint32 validationIntervalMs = 500;
+    
+    const File directory;
+    const String extension;
+    const File catalogueFile;
+    
+    CriticalSection scanLock;
+    std::map<String, std::map<String, String>> pendingMetadata;
+    mutable SpinLock snapshotLock;
+    std::shared_ptr<const Snapshot> snapshot;
+    std::atomic<bool> isDirty{ false };
+    std::atomic<uint32> lastValidationTime{ 0 };
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PresetCatalogue);
+};
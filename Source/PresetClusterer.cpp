@@ -0,0 +1,322 @@
+/*
+  ==============================================================================
+
+    PresetClusterer.cpp
+    Created: 19 Oct 2026 6:52:16am
+
+  ==============================================================================
+*/
+
+#include "PresetClusterer.h"
+
+const String PresetClusterer::metadataKey{ "cluster" };
+
+PresetClusterer::PresetClusterer(int numThreadsToUse)
+    : Thread("Preset clustering"), threadPool(numThreadsToUse), numThreads(jmax(1, numThreadsToUse))
+{
+}
+
+PresetClusterer::~PresetClusterer()
+{
+    stopThread(10000);
+    threadPool.removeAllJobs(true, 5000);
+}
+
+bool PresetClusterer::start(std::shared_ptr<const PresetCatalogue::Snapshot> snapshotToCluster, int numClusters,
+                            CompletionCallback onComplete)
+{
+    if (isThreadRunning() || snapshotToCluster == nullptr){
+        return false;
+    }
+    
+    snapshot = std::move(snapshotToCluster);
+    requestedClusters = numClusters;
+    completionCallback = std::move(onComplete);
+    return startThread();
+}
+
+bool PresetClusterer::isBusy() const
+{
+    return isThreadRunning();
+}
+
+void PresetClusterer::run()
+{
+    auto labels = cluster(*snapshot, requestedClusters);
+    snapshot.reset();
+    
+    if (!threadShouldExit() && completionCallback != nullptr){
+        completionCallback(std::move(labels));
+    }
+}
+
+PresetClusterer::Labels PresetClusterer::cluster(const PresetCatalogue::Snapshot& catalogue, int numClusters)
+{
+    const auto values = packValues(catalogue);
+    if (values.numRows == 0){
+        return {};
+    }
+    
+    if (numClusters <= 0){
+        numClusters = jlimit(2, maxAutomaticClusters, roundToInt(std::sqrt(values.numRows / 2.0)));
+    }
+    numClusters = jmin(numClusters, values.numRows);
+    
+    auto centres = chooseInitialCentres(values, numClusters);
+    const auto assignments = assignClusters(values, centres);
+    if (threadShouldExit()){
+        return {};
+    }
+    
+    const auto clusterNames = nameClusters(values, centres);
+    
+    Labels labels;
+    for (int row = 0; row < values.numRows; ++row){
+        labels[catalogue.entries[(size_t) row].name] = clusterNames[assignments[(size_t) row]];
+    }
+    return labels;
+}
+
+PresetClusterer::Matrix PresetClusterer::packValues(const PresetCatalogue::Snapshot& catalogue)
+{
+    Matrix values;
+    values.numRows = (int) catalogue.entries.size();
+    values.numColumns = Parameters::numParameters;
+    values.stride = (values.numColumns + blockSize - 1) / blockSize * blockSize;
+    values.data.assign((size_t) values.numRows * (size_t) values.stride, 0.0f);
+    
+    // Normalised, so that parameters with wide ranges don't dominate the distances.
+    for (int row = 0; row < values.numRows; ++row)
+    {
+        const auto& entryValues = catalogue.entries[(size_t) row].values;
+        auto* destination = values.getRow(row);
+        for (int column = 0; column < values.numColumns; ++column)
+        {
+            const auto& descriptor = Parameters::descriptors[(size_t) column];
+            destination[column] = (entryValues[(size_t) column] - descriptor.minValue) / (descriptor.maxValue - descriptor.minValue);
+        }
+    }
+    return values;
+}
+
+PresetClusterer::Matrix PresetClusterer::chooseInitialCentres(const Matrix& values, int numClusters)
+{
+    Matrix centres;
+    centres.numRows = numClusters;
+    centres.numColumns = values.numColumns;
+    centres.stride = values.stride;
+    centres.data.assign((size_t) numClusters * (size_t) values.stride, 0.0f);
+    
+    // k-means++: each new centre is picked with a probability proportional to its squared distance from
+    // the nearest centre so far. A fixed seed keeps the groups stable between runs on the same library.
+    Random random{ 1 };
+    std::vector<float> nearestDistance((size_t) values.numRows, std::numeric_limits<float>::max());
+    auto chosenRow = random.nextInt(values.numRows);
+    
+    for (int centre = 0; centre < numClusters && !threadShouldExit(); ++centre)
+    {
+        std::copy_n(values.getRow(chosenRow), values.stride, centres.getRow(centre));
+        const auto* centreValues = centres.getRow(centre);
+        
+        parallelFor(values.numRows, [&](int begin, int end, int)
+        {
+            for (int row = begin; row < end; ++row)
+            {
+                const auto* rowValues = values.getRow(row);
+                auto distance = 0.0f;
+                for (int column = 0; column < values.stride; ++column){
+                    distance += (rowValues[column] - centreValues[column]) * (rowValues[column] - centreValues[column]);
+                }
+                nearestDistance[(size_t) row] = jmin(nearestDistance[(size_t) row], distance);
+            }
+        });
+        
+        const auto totalDistance = std::accumulate(nearestDistance.begin(), nearestDistance.end(), 0.0);
+        // Fewer distinct presets than clusters: the remaining centres stay duplicates.
+        if (totalDistance <= 0.0){
+            continue;
+        }
+        
+        auto target = random.nextDouble() * totalDistance;
+        for (int row = 0; row < values.numRows; ++row)
+        {
+            target -= nearestDistance[(size_t) row];
+            if (target <= 0.0)
+            {
+                chosenRow = row;
+                break;
+            }
+        }
+    }
+    return centres;
+}
+
+std::vector<int> PresetClusterer::assignClusters(const Matrix& values, Matrix& centres)
+{
+    std::vector<int> assignments((size_t) values.numRows, -1);
+    const auto numClusters = centres.numRows;
+    const auto numChunks = getNumChunks(values.numRows);
+    
+    // Per chunk partial sums, so that no two workers ever write to the same memory.
+    std::vector<std::vector<double>> chunkSums((size_t) numChunks);
+    std::vector<std::vector<int>> chunkCounts((size_t) numChunks);
+    std::vector<int> chunkChanges((size_t) numChunks);
+    std::vector<float> centreNorms((size_t) numClusters);
+    
+    for (int iteration = 0; iteration < maxIterations && !threadShouldExit(); ++iteration)
+    {
+        for (int centre = 0; centre < numClusters; ++centre){
+            centreNorms[(size_t) centre] = dotProduct(centres.getRow(centre), centres.getRow(centre), centres.stride);
+        }
+        
+        // |x - c|^2 = |x|^2 - 2 x.c + |c|^2, and |x|^2 is the same for every centre, so only the dot
+        // products are needed per pair.
+        parallelFor(values.numRows, [&](int begin, int end, int chunk)
+        {
+            auto& sums = chunkSums[(size_t) chunk];
+            auto& counts = chunkCounts[(size_t) chunk];
+            sums.assign((size_t) numClusters * (size_t) values.stride, 0.0);
+            counts.assign((size_t) numClusters, 0);
+            chunkChanges[(size_t) chunk] = 0;
+            
+            for (int row = begin; row < end; ++row)
+            {
+                const auto* rowValues = values.getRow(row);
+                auto nearest = 0;
+                auto nearestDistance = std::numeric_limits<float>::max();
+                
+                for (int centre = 0; centre < numClusters; ++centre)
+                {
+                    const auto distance = centreNorms[(size_t) centre] - 2.0f * dotProduct(rowValues, centres.getRow(centre), values.stride);
+                    if (distance < nearestDistance)
+                    {
+                        nearestDistance = distance;
+                        nearest = centre;
+                    }
+                }
+                
+                if (assignments[(size_t) row] != nearest)
+                {
+                    assignments[(size_t) row] = nearest;
+                    ++chunkChanges[(size_t) chunk];
+                }
+                
+                auto* sum = sums.data() + (size_t) nearest * (size_t) values.stride;
+                for (int column = 0; column < values.stride; ++column){
+                    sum[column] += rowValues[column];
+                }
+                ++counts[(size_t) nearest];
+            }
+        });
+        
+        for (int centre = 0; centre < numClusters; ++centre)
+        {
+            auto count = 0;
+            for (const auto& counts : chunkCounts){
+                count += counts[(size_t) centre];
+            }
+            
+            // A centre that lost all its presets stays where it was.
+            if (count == 0){
+                continue;
+            }
+            
+            auto* centreValues = centres.getRow(centre);
+            for (int column = 0; column < centres.stride; ++column)
+            {
+                auto sum = 0.0;
+                for (const auto& sums : chunkSums){
+                    sum += sums[(size_t) centre * (size_t) centres.stride + (size_t) column];
+                }
+                centreValues[column] = (float) (sum / count);
+            }
+        }
+        
+        if (std::accumulate(chunkChanges.begin(), chunkChanges.end(), 0) == 0){
+            break;
+        }
+    }
+    return assignments;
+}
+
+StringArray PresetClusterer::nameClusters(const Matrix& values, const Matrix& centres)
+{
+    std::vector<double> mean((size_t) values.numColumns, 0.0);
+    for (int row = 0; row < values.numRows; ++row)
+    {
+        const auto* rowValues = values.getRow(row);
+        for (int column = 0; column < values.numColumns; ++column){
+            mean[(size_t) column] += rowValues[column];
+        }
+    }
+    for (auto& columnMean : mean){
+        columnMean /= values.numRows;
+    }
+    
+    StringArray names;
+    for (int centre = 0; centre < centres.numRows; ++centre)
+    {
+        const auto* centreValues = centres.getRow(centre);
+        auto mostDistinctive = 0;
+        for (int column = 1; column < values.numColumns; ++column)
+        {
+            if (std::abs(centreValues[column] - mean[(size_t) column])
+                > std::abs(centreValues[mostDistinctive] - mean[(size_t) mostDistinctive]))
+            {
+                mostDistinctive = column;
+            }
+        }
+        
+        const auto prefix = centreValues[mostDistinctive] >= mean[(size_t) mostDistinctive] ? "High " : "Low ";
+        const auto baseName = prefix + Parameters::toString(Parameters::descriptors[(size_t) mostDistinctive].name);
+        
+        auto name = baseName;
+        for (int suffix = 2; names.contains(name); ++suffix){
+            name = baseName + " " + String(suffix);
+        }
+        names.add(name);
+    }
+    return names;
+}
+
+void PresetClusterer::parallelFor(int numItems, const std::function<void(int begin, int end, int chunk)>& function)
+{
+    const auto numChunks = getNumChunks(numItems);
+    const auto chunkSize = (numItems + numChunks - 1) / numChunks;
+    
+    std::atomic<int> numRemaining{ numChunks };
+    WaitableEvent finished;
+    
+    for (int chunk = 0; chunk < numChunks; ++chunk)
+    {
+        const auto begin = chunk * chunkSize;
+        const auto end = jmin(numItems, begin + chunkSize);
+        threadPool.addJob([&, begin, end, chunk]
+        {
+            function(begin, end, chunk);
+            if (--numRemaining == 0){
+                finished.signal();
+            }
+        });
+    }
+    finished.wait();
+}
+
+int PresetClusterer::getNumChunks(int numItems) const
+{
+    // A few chunks per thread, so that one slow worker doesn't hold up the others.
+    return jlimit(1, jmax(1, numItems), numThreads * 4);
+}
+
+float PresetClusterer::dotProduct(const float* first, const float* second, int stride) noexcept
+{
+    // Independent partial sums for each lane of a block, which compilers turn into vector instructions.
+    std::array<float, blockSize> partialSums{};
+    for (int block = 0; block < stride; block += blockSize)
+    {
+        for (int lane = 0; lane < blockSize; ++lane){
+            partialSums[(size_t) lane] += first[block + lane] * second[block + lane];
+        }
+    }
+    return std::accumulate(partialSums.begin(), partialSums.end(), 0.0f);
+}
@@ -0,0 +1,83 @@
+/*
+  ==============================================================================
+
+    PresetClusterer.h
+    Created: 19 Oct 2026 6:52:16am
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "PresetCatalogue.h"
+
+// Groups a preset library by sound, using k-means over every preset's normalised parameter values.
+// The values are packed into one row-major matrix, padded so rows are a whole number of SIMD-friendly
+// blocks, and every pass over it is split across a ThreadPool. Each group is named after the parameter
+// that sets its centre furthest apart from the rest of the library, e.g. "High Attack".
+class PresetClusterer : private Thread
+{
+public:
+    explicit PresetClusterer(int numThreads = SystemStats::getNumCpus());
+    
+    ~PresetClusterer() override;
+    
+    // Preset name to group name, for every preset in the snapshot.
+    using Labels = std::map<String, String>;
+    
+    // Called on the clustering thread once every preset has been labelled.
+    using CompletionCallback = std::function<void(Labels&& labels)>;
+    
+    // Returns false if clustering is already running. Pass 0 clusters to choose from the library size.
+    bool start(std::shared_ptr<const PresetCatalogue::Snapshot> snapshot, int numClusters, CompletionCallback onComplete);
+    
+    bool isBusy() const;
+    
+    // The metadata key labels are stored under.
+    static const String metadataKey;
+    
+private:
+    struct Matrix
+    {
+        int numRows = 0;
+        int numColumns = 0;
+        int stride = 0;
+        std::vector<float> data;
+        
+        float* getRow(int row) noexcept { return data.data() + (size_t) row * (size_t) stride; }
+        const float* getRow(int row) const noexcept { return data.data() + (size_t) row * (size_t) stride; }
+    };
+    
+    void run() override;
+    
+    Labels cluster(const PresetCatalogue::Snapshot& catalogue, int numClusters);
+    
+    static Matrix packValues(const PresetCatalogue::Snapshot& catalogue);
+    
+    Matrix chooseInitialCentres(const Matrix& values, int numClusters);
+    
+    std::vector<int> assignClusters(const Matrix& values, Matrix& centres);
+    
+    static StringArray nameClusters(const Matrix& values, const Matrix& centres);
+    
+    // Runs the function over [begin, end) chunks of the range on the pool, and waits for all of them.
+    void parallelFor(int numItems, const std::function<void(int begin, int end, int chunk)>& function);
+    
+    int getNumChunks(int numItems) const;
+    
+    static float dotProduct(const float* first, const float* second, int stride) noexcept;
+    
+    static constexpr int blockSize = 8;
+    static constexpr int maxIterations = 25;
+    static constexpr int maxAutomaticClusters = 12;
+    
+    ThreadPool threadPool;
+    const int numThreads;
+    
+    std::shared_ptr<const PresetCatalogue::Snapshot> snapshot;
+    int requestedClusters = 0;
+    CompletionCallback completionCallback;
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PresetClusterer);
+};
@@ -0,0 +1,71 @@
+/*
+  ==============================================================================
+
+    PresetHandoff.h
+    Created: 19 Oct 2026 6:34:35am
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Parameters.h"
+
+// Passes decoded presets from the message thread to the audio thread without locking or allocating.
+// The audio thread applies only the most recent one when several arrive within a single block.
+class PresetHandoff
+{
+public:
+    // Message thread. Returns false if the audio thread hasn't drained earlier presets yet.
+    bool push(const Parameters::Values& values) noexcept
+    {
+        const auto scope = fifo.write(1);
+        if (scope.blockSize1 == 0){
+            return false;
+        }
+        pending[scope.startIndex1] = values;
+        return true;
+    }
+    
+    // Audio thread. Returns how many presets were drained, of which only the latest is returned.
+    int pop(Parameters::Values& values) noexcept
+    {
+        const auto numReady = fifo.getNumReady();
+        if (numReady == 0){
+            return 0;
+        }
+        
+        const auto scope = fifo.read(numReady);
+        values = scope.blockSize2 > 0 ? pending[scope.startIndex2 + scope.blockSize2 - 1]
+                                      : pending[scope.startIndex1 + scope.blockSize1 - 1];
+        return numReady;
+    }
+    
+    // Any thread. True while presets are waiting for the audio thread.
+    bool hasPending() const noexcept
+    {
+        return fifo.getNumReady() > 0;
+    }
+    
+    // Audio thread, once per block.
+    void markBlockProcessed() noexcept
+    {
+        lastBlockTime.store(Time::getMillisecondCounter(), std::memory_order_relaxed);
+    }
+    
+    // When the host has stopped calling processBlock, nothing would drain the handoff.
+    bool isAudioRunning() const noexcept
+    {
+        const auto lastBlock = lastBlockTime.load(std::memory_order_relaxed);
+        return lastBlock != 0 && Time::getMillisecondCounter() - lastBlock < audioTimeoutMs;
+    }
+    
+private:
+    static constexpr int capacity = 16;
+    static constexpr uint32 audioTimeoutMs = 200;
+    
+    AbstractFifo fifo{ capacity };
+    std::array<Parameters::Values, capacity> pending;
+    std::atomic<uint32> lastBlockTime{ 0 };
+};
@@ -9,34 +9,81 @@
 */
 
 #include "PresetManager.h"
+#include "RealtimeSafety.h"
 
-const File PresetManager::defaultDirectory
-{ File::getSpecialLocation(File::SpecialLocationType::commonDocumentsDirectory)
-    .getChildFile(ProjectInfo::companyName)
-    .getChildFile(ProjectInfo::projectName)
-};
 const String PresetManager::extension{ "preset" };
 const String PresetManager::presetNameProperty{ "presetName" };
+const String PresetManager::basePresetProperty{ "basePreset" };
+const String PresetManager::derivedStorageProperty{ "derivedStorage" };
+const Identifier PresetManager::quickSlotsType{ "QUICK_SLOTS" };
 
-PresetManager::PresetManager(AudioProcessorValueTreeState& tree) : treeRef(tree)
+PresetManager::PresetManager(AudioProcessorValueTreeState& tree, ParameterSnapshot& snapshot) : treeRef(tree), snapshotRef(snapshot)
 {
-    if (!defaultDirectory.exists()){
-        {
-            const auto result = defaultDirectory.createDirectory();
-            if (result.failed())
-            {
-                DBG("Could not create Preset Directory");
-                jassertfalse;
-            }
-        }
+    for (int index = 0; index < Parameters::numParameters; ++index)
+    {
+        parameters[index] = treeRef.getParameter(Parameters::toString(Parameters::descriptors[index].id));
+        jassert(parameters[index] != nullptr);
     }
+    
     currentPreset = treeRef.state.getPropertyAsValue(presetNameProperty, nullptr).toString();
     treeRef.state.addListener(this);
+    
+    // VST2 and VST3 wrappers size their program list as soon as the plugin is constructed, long before a
+    // scan could finish, so they're given the count the sidecars recorded last session.
+    storedProgramCount = LayeredPresetCatalogue::readStoredEntryCount(getLayers(), extension);
 }
 
 PresetManager::~PresetManager()
 {
+    stopTimer();
     treeRef.state.removeListener(this);
+    
+    // Imports and clustering write into the catalogue from their own threads, so they have to stop first.
+    presetPack.reset();
+    presetClusterer.reset();
+    catalogue.reset();
+}
+
+const File& PresetManager::getUserDirectory()
+{
+    static const File userDirectory
+    { File::getSpecialLocation(File::SpecialLocationType::userDocumentsDirectory)
+        .getChildFile(ProjectInfo::companyName)
+        .getChildFile(ProjectInfo::projectName)
+    };
+    return userDirectory;
+}
+
+const File& PresetManager::getDefaultDirectory()
+{
+    static const File defaultDirectory
+    { File::getSpecialLocation(File::SpecialLocationType::commonDocumentsDirectory)
+        .getChildFile(ProjectInfo::companyName)
+        .getChildFile(ProjectInfo::projectName)
+    };
+    return defaultDirectory;
+}
+
+const File& PresetManager::getSharedDirectory()
+{
+    static const File sharedDirectory
+    { File::getSpecialLocation(File::SpecialLocationType::commonApplicationDataDirectory)
+        .getChildFile(ProjectInfo::companyName)
+        .getChildFile(ProjectInfo::projectName)
+        .getChildFile("Shared Presets")
+    };
+    return sharedDirectory;
+}
+
+const File& PresetManager::getFactoryDirectory()
+{
+    static const File factoryDirectory
+    { File::getSpecialLocation(File::SpecialLocationType::commonApplicationDataDirectory)
+        .getChildFile(ProjectInfo::companyName)
+        .getChildFile(ProjectInfo::projectName)
+        .getChildFile("Factory Presets")
+    };
+    return factoryDirectory;
 }
 
 void PresetManager::savePreset(const String& presetName)
@@ -45,14 +92,93 @@ void PresetManager::savePreset(const String& presetName)
         return;
     }
     
-    const auto xmlCurrentState = treeRef.copyState().createXml();
-    const auto presetFile = defaultDirectory.getChildFile(presetName + "." + extension);
-    if (!xmlCurrentState->writeTo(presetFile))
+    // Presets stored relative to the one being overwritten would silently change with it, so they keep
+    // the values they have now.
+    flattenPresetsDerivedFrom(presetName);
+    
+    if (derivedStorageEnabled && currentPreset.isNotEmpty() && currentPreset != presetName)
     {
-        jassertfalse;
+        saveDerivedPreset(presetName, currentPreset);
+        return;
     }
+    
+    writePresetState(presetName, createStateFromSnapshot());
+    currentPreset = presetName;
+    presetLibraryChanged();
+}
 
+void PresetManager::saveDerivedPreset(const String& presetName, const String& basePresetName)
+{
+    if (presetName.isEmpty()){
+        return;
+    }
+    
+    const auto currentValues = readParameterSnapshot();
+    const auto currentState = createPresetState(currentValues);
+    
+    // A preset can't be stored relative to itself or to anything that already derives from it.
+    const auto canDerive = basePresetName.isNotEmpty()
+                        && basePresetName != presetName
+                        && !isDerivedFrom(basePresetName, presetName);
+    const auto baseValues = canDerive ? getPresetValues(basePresetName) : std::nullopt;
+    
+    if (!baseValues.has_value())
+    {
+        writePresetState(presetName, currentState);
+        currentPreset = presetName;
+        presetLibraryChanged();
+        return;
+    }
+    
+    ValueTree derivedState{ currentState.getType() };
+    derivedState.copyPropertiesFrom(currentState, nullptr);
+    derivedState.setProperty(basePresetProperty, basePresetName, nullptr);
+    
+    // The preset state holds one child per parameter, in parameter order.
+    for (int index = 0; index < Parameters::numParameters; ++index)
+    {
+        if (currentValues[index] != (*baseValues)[index]){
+            derivedState.appendChild(currentState.getChild(index).createCopy(), nullptr);
+        }
+    }
+    
+    writePresetState(presetName, derivedState);
     currentPreset = presetName;
+    presetLibraryChanged();
+}
+
+void PresetManager::flattenPreset(const String& presetName)
+{
+    const auto entry = getCatalogueEntry(presetName);
+    if (!entry.has_value() || entry->basePresetName.isEmpty()){
+        return;
+    }
+    
+    // Rewritten where it is, which may be a lower writable layer than the one new presets are saved to.
+    if (!createFlattenedState(*entry).createXml()->writeTo(entry->file)){
+        jassertfalse;
+    }
+}
+
+ValueTree PresetManager::createFlattenedState(const PresetCatalogue::Entry& entry) const
+{
+    // The values come from the catalogue, which already resolved them against the base.
+    auto flattenedState = createPresetState(entry.values);
+    if (const auto xmlState = XmlDocument::parse(entry.file)){
+        flattenedState.copyPropertiesFrom(ValueTree::fromXml(*xmlState), nullptr);
+    }
+    flattenedState.removeProperty(basePresetProperty, nullptr);
+    return flattenedState;
+}
+
+void PresetManager::setDerivedStorageEnabled(bool shouldStoreDerived)
+{
+    derivedStorageEnabled = shouldStoreDerived;
+}
+
+bool PresetManager::isDerivedStorageEnabled() const
+{
+    return derivedStorageEnabled.load();
 }
 
 void PresetManager::deletePreset(const String& presetName)
@@ -61,7 +187,17 @@ void PresetManager::deletePreset(const String& presetName)
         return;
     }
     
-    const auto presetFile = defaultDirectory.getChildFile(presetName + "." + extension);
+    if (!canDeletePreset(presetName))
+    {
+        DBG("Preset is read-only or does not exist");
+        return;
+    }
+    
+    // The file in whichever writable layer the preset comes from, not necessarily the one saved to.
+    const auto presetFile = getCatalogueEntry(presetName)->file;
+    
+    // Presets stored relative to this one would be left dangling, so give them their full state first.
+    flattenPresetsDerivedFrom(presetName);
     
     if (!presetFile.deleteFile())
     {
@@ -71,6 +207,23 @@ void PresetManager::deletePreset(const String& presetName)
     }
     
     currentPreset = "";
+    presetLibraryChanged();
+}
+
+bool PresetManager::canDeletePreset(const String& presetName)
+{
+    const auto entry = getCatalogueEntry(presetName);
+    return entry.has_value() && getCatalogue().getLayer(entry->layer).isWritable && entry->file.existsAsFile();
+}
+
+std::optional<PresetCatalogue::Entry> PresetManager::getCatalogueEntry(const String& presetName)
+{
+    const auto snapshot = getCatalogue().getSnapshot();
+    const auto index = snapshot->indexOf(presetName);
+    if (index < 0){
+        return std::nullopt;
+    }
+    return snapshot->entries[(size_t) index];
 }
 
 void PresetManager::loadPreset(const String& presetName)
@@ -78,23 +231,47 @@ void PresetManager::loadPreset(const String& presetName)
     if (presetName.isEmpty())
         return;
     
-    const auto presetFile = defaultDirectory.getChildFile(presetName + "." + extension);
+    const auto values = getPresetValues(presetName);
+    if (!values.has_value())
+    {
+        jassertfalse;
+        return;
+    }
     
-    if (!presetFile.existsAsFile())
+    applyParameterValues(*values);
+    currentPreset = presetName;
+}
+
+void PresetManager::broadcastPreset(const String& presetName)
+{
+    const auto values = getPresetValues(presetName);
+    if (!values.has_value())
     {
         jassertfalse;
         return;
     }
     
-    XmlDocument xmlDocument{ presetFile };
-    const auto valueTreeToLoad = ValueTree::fromXml(*xmlDocument.getDocumentElement());
-    treeRef.replaceState(valueTreeToLoad);
+    applyParameterValues(*values);
     currentPreset = presetName;
+    presetBroadcast.publish(presetName, *values);
+}
+
+void PresetManager::setLinked(bool shouldBeLinked)
+{
+    linked = shouldBeLinked;
+    if (shouldBeLinked){
+        startPollingAudioThread();
+    }
+}
+
+bool PresetManager::isLinked() const
+{
+    return linked.load();
 }
 
 int PresetManager::nextPreset()
 {
-    const auto allPresets = getAllPresets();
+    const auto allPresets = getPresetsInGroupOrder();
     if (allPresets.isEmpty())
     {
         return -1;
@@ -109,36 +286,696 @@ int PresetManager::nextPreset()
 
 int PresetManager::previousPreset()
 {
-    const auto allPresets = getAllPresets();
+    const auto allPresets = getPresetsInGroupOrder();
     if (allPresets.isEmpty())
     {
         return -1;
     }
     
     const auto currentIndex = allPresets.indexOf(currentPreset);
-    const auto nextIndex = currentIndex - 1 < 0 ? (allPresets.size() - 1) : 0;
+    const auto nextIndex = currentIndex - 1 < 0 ? (allPresets.size() - 1) : currentIndex - 1;
     const auto nameOfNextPreset = allPresets.getReference(nextIndex);
     loadPreset(nameOfNextPreset);
     return nextIndex;
 }
 
-StringArray PresetManager::getAllPresets()
+StringArray PresetManager::getPresetsInGroupOrder()
 {
-    StringArray presets;
-    const auto fileArray = defaultDirectory.findChildFiles(File::TypesOfFileToFind::findFiles, false, "*" + extension);
-    for (const auto& file : fileArray)
-    {
-        presets.add(file.getFileNameWithoutExtension());
+    StringArray presetNames;
+    for (const auto& group : getPresetGroups()){
+        presetNames.addArray(group.second);
     }
-    return presets;
+    return presetNames;
+}
+
+StringArray PresetManager::getAllPresets()
+{
+    return getCatalogue().getSnapshot()->names;
+}
+
+void PresetManager::prepareCatalogue()
+{
+    getCatalogue().scanInBackground();
+}
+
+bool PresetManager::isCatalogueReady() const
+{
+    return catalogue != nullptr && !catalogue->needsScan();
 }
 
 String PresetManager::getCurrentPreset()
 {
+    syncProgramChangedFromAudioThread();
     return currentPreset;
 }
 
+bool PresetManager::exportPresetPack(const File& packFile, const StringArray& presetNames, bool flattenDerived,
+                                     PresetPack::ProgressCallback onProgress, PresetPack::CompletionCallback onComplete)
+{
+    const auto snapshot = getCatalogue().getSnapshot();
+    
+    // The list grows while it's walked, so bases of bases are picked up too.
+    StringArray namesToExport{ presetNames };
+    std::vector<PresetPack::ExportItem> presets;
+    for (int index = 0; index < namesToExport.size(); ++index)
+    {
+        const auto entryIndex = snapshot->indexOf(namesToExport[index]);
+        if (entryIndex < 0){
+            continue;
+        }
+        
+        const auto& entry = snapshot->entries[(size_t) entryIndex];
+        PresetPack::ExportItem preset{ entry.name, entry.file, {} };
+        
+        if (entry.basePresetName.isNotEmpty() && flattenDerived)
+        {
+            const auto xml = createFlattenedState(entry).createXml()->toString();
+            preset.content.append(xml.toRawUTF8(), xml.getNumBytesAsUTF8());
+        }
+        else if (entry.basePresetName.isNotEmpty())
+        {
+            namesToExport.addIfNotAlreadyThere(entry.basePresetName);
+        }
+        presets.push_back(std::move(preset));
+    }
+    
+    return getPresetPack().exportPack(std::move(presets), packFile, std::move(onProgress), std::move(onComplete));
+}
+
+bool PresetManager::containsDerivedPresets(const StringArray& presetNames)
+{
+    const auto snapshot = getCatalogue().getSnapshot();
+    return std::any_of(presetNames.begin(), presetNames.end(), [&snapshot](const String& presetName)
+    {
+        const auto index = snapshot->indexOf(presetName);
+        return index >= 0 && snapshot->entries[(size_t) index].basePresetName.isNotEmpty();
+    });
+}
+
+bool PresetManager::importPresetPack(const File& packFile,
+                                     PresetPack::ProgressCallback onProgress, PresetPack::CompletionCallback onComplete)
+{
+    auto& layeredCatalogue = getCatalogue();
+    const auto writableLayer = layeredCatalogue.getWritableLayer();
+    
+    return getPresetPack().importPack(packFile, getWritableDirectory(), extension, [&layeredCatalogue, writableLayer](auto&& entries)
+    {
+        layeredCatalogue.addEntries(writableLayer, std::move(entries));
+    }, std::move(onProgress), std::move(onComplete));
+}
+
+bool PresetManager::isPresetPackBusy() const
+{
+    return presetPack != nullptr && presetPack->isBusy();
+}
+
+bool PresetManager::clusterPresets(int numClusters)
+{
+    auto& layeredCatalogue = getCatalogue();
+    return getPresetClusterer().start(layeredCatalogue.getSnapshot(), numClusters, [&layeredCatalogue](auto&& labels)
+    {
+        layeredCatalogue.setMetadata(PresetClusterer::metadataKey, labels);
+    });
+}
+
+bool PresetManager::isClustering() const
+{
+    return presetClusterer != nullptr && presetClusterer->isBusy();
+}
+
+std::vector<std::pair<String, StringArray>> PresetManager::getPresetGroups()
+{
+    std::map<String, StringArray> groups;
+    for (const auto& entry : getCatalogue().getSnapshot()->entries){
+        groups[entry.metadata.getValue(PresetClusterer::metadataKey, {})].add(entry.name);
+    }
+    return { groups.begin(), groups.end() };
+}
+
+Parameters::Values PresetManager::decodeParameterValues(const ValueTree& state) const
+{
+    auto values = Parameters::getDefaultValues();
+    for (const auto& child : state)
+    {
+        const auto index = Parameters::getIndex(child.getProperty("id").toString());
+        if (index >= 0){
+            values[index] = static_cast<float>(child.getProperty("value"));
+        }
+    }
+    return values;
+}
+
+std::optional<Parameters::Values> PresetManager::getPresetValues(const String& presetName)
+{
+    const auto snapshot = getCatalogue().getSnapshot();
+    const auto index = snapshot->indexOf(presetName);
+    if (index < 0){
+        return std::nullopt;
+    }
+    return snapshot->entries[(size_t) index].values;
+}
+
+void PresetManager::applyParameterValues(const Parameters::Values& values)
+{
+    const auto changes = getParameterChanges(values);
+    snapshotRef.beginApply();
+    
+    // Hosts that record undo or automation see every gesture open before any value moves, and so treat
+    // the whole preset as a single edit instead of one per parameter.
+    for (int index = 0; index < Parameters::numParameters; ++index)
+    {
+        if (changes[index].has_value()){
+            parameters[index]->beginChangeGesture();
+        }
+    }
+    
+    for (int index = 0; index < Parameters::numParameters; ++index)
+    {
+        if (changes[index].has_value()){
+            parameters[index]->setValueNotifyingHost(*changes[index]);
+        }
+    }
+    
+    for (int index = 0; index < Parameters::numParameters; ++index)
+    {
+        if (changes[index].has_value()){
+            parameters[index]->endChangeGesture();
+        }
+    }
+    
+    markStateReplaced();
+    snapshotRef.endApply();
+    hostDisplayUpdatePending = false;
+    treeRef.processor.updateHostDisplay(AudioProcessorListener::ChangeDetails().withProgramChanged(true));
+}
+
+void PresetManager::applyParameterValuesFromAudioThread(const Parameters::Values& values) noexcept
+{
+    const auto changes = getParameterChanges(values);
+    snapshotRef.beginApply();
+    
+    {
+        // JUCE briefly locks the processor's listener list to notify the host, as every plugin's parameter
+        // changes do. That lock is expected here; anything else this does is still reported.
+        const RealtimeSafety::ScopedPermittedLocks permittedLocks;
+        for (int index = 0; index < Parameters::numParameters; ++index)
+        {
+            if (changes[index].has_value()){
+                parameters[index]->setValueNotifyingHost(*changes[index]);
+            }
+        }
+    }
+    
+    markStateReplaced();
+    snapshotRef.endApply();
+    hostDisplayUpdatePending = true;
+}
+
+void PresetManager::restoreState(const ValueTree& state)
+{
+    // Only the properties are copied; parameters go through their own objects rather than replaceState(),
+    // which would notify the host of every parameter whether it changed or not.
+    treeRef.state.copyPropertiesFrom(state, nullptr);
+    currentPreset = state.getProperty(presetNameProperty).toString();
+    
+    // While audio runs, presets may still be queued for the audio thread. The restored values are queued
+    // behind them, so that they win and a state read straight after this call returns them.
+    const auto values = decodeParameterValues(state);
+    if (queueForAudioThread(values)){
+        return;
+    }
+    
+    const auto changes = getParameterChanges(values);
+    snapshotRef.beginApply();
+    for (int index = 0; index < Parameters::numParameters; ++index)
+    {
+        if (changes[index].has_value()){
+            parameters[index]->setValueNotifyingHost(*changes[index]);
+        }
+    }
+    markStateReplaced();
+    snapshotRef.endApply();
+}
+
+PresetManager::ParameterChanges PresetManager::getParameterChanges(const Parameters::Values& values) const noexcept
+{
+    ParameterChanges changes;
+    for (int index = 0; index < Parameters::numParameters; ++index)
+    {
+        const auto* parameter = parameters[index];
+        const auto normalisedValue = parameter->convertTo0to1(values[index]);
+        if (normalisedValue != parameter->getValue()){
+            changes[index] = normalisedValue;
+        }
+    }
+    return changes;
+}
+
+uint32 PresetManager::getStateGeneration() const noexcept
+{
+    return stateGeneration.load(std::memory_order_acquire);
+}
+
+void PresetManager::markStateReplaced() noexcept
+{
+    // Bumped before the new values are published, so that anyone who reads them sees the new generation too.
+    stateGeneration.fetch_add(1, std::memory_order_release);
+}
+
+ValueTree PresetManager::createPresetState(const Parameters::Values& values) const
+{
+    ValueTree state{ treeRef.state.getType() };
+    state.setProperty(presetNameProperty, currentPreset, nullptr);
+    state.setProperty("version", ProjectInfo::versionString, nullptr);
+    
+    for (int index = 0; index < Parameters::numParameters; ++index)
+    {
+        state.appendChild(ValueTree{ "PARAM", {
+            { "id", Parameters::toString(Parameters::descriptors[index].id) },
+            { "value", values[index] }
+        }}, nullptr);
+    }
+    return state;
+}
+
+ValueTree PresetManager::createStateFromSnapshot()
+{
+    return createPresetState(readParameterSnapshot());
+}
+
+Parameters::Values PresetManager::readParameterSnapshot() const noexcept
+{
+    if (!presetHandoff.isAudioRunning()){
+        snapshotRef.update();
+    }
+    return snapshotRef.read();
+}
+
+void PresetManager::assignQuickSlot(int slot)
+{
+    if (!isPositiveAndBelow(slot, numQuickSlots)){
+        return;
+    }
+    
+    quickSlots[slot] = { currentPreset, readParameterSnapshot() };
+}
+
+void PresetManager::recallQuickSlot(int slot)
+{
+    if (!isQuickSlotAssigned(slot)){
+        return;
+    }
+    
+    const auto& quickSlot = quickSlots[slot];
+    handOffParameterValues(*quickSlot.values);
+    currentPreset = quickSlot.presetName;
+}
+
+void PresetManager::handOffParameterValues(const Parameters::Values& values)
+{
+    if (!queueForAudioThread(values)){
+        applyParameterValues(values);
+    }
+}
+
+bool PresetManager::queueForAudioThread(const Parameters::Values& values)
+{
+    if (!presetHandoff.isAudioRunning()){
+        return false;
+    }
+    
+    // The snapshot shows the values as soon as they're queued, and keeps showing them until the audio
+    // thread has applied them, so a state read straight after this call already contains them.
+    snapshotRef.beginApply();
+    if (presetHandoff.push(values))
+    {
+        markStateReplaced();
+        snapshotRef.publish(values);
+        startPollingAudioThread();
+        return true;
+    }
+    snapshotRef.endApply();
+    return false;
+}
+
+bool PresetManager::isQuickSlotAssigned(int slot) const
+{
+    return isPositiveAndBelow(slot, numQuickSlots) && quickSlots[slot].values.has_value();
+}
+
+String PresetManager::getQuickSlotPresetName(int slot) const
+{
+    return isQuickSlotAssigned(slot) ? quickSlots[slot].presetName : String();
+}
+
+ValueTree PresetManager::getQuickSlotState() const
+{
+    ValueTree quickSlotState{ quickSlotsType };
+    for (int slot = 0; slot < numQuickSlots; ++slot)
+    {
+        if (!isQuickSlotAssigned(slot)){
+            continue;
+        }
+        
+        auto slotState = createPresetState(*quickSlots[slot].values);
+        slotState.setProperty(presetNameProperty, quickSlots[slot].presetName, nullptr);
+        slotState.setProperty("slot", slot, nullptr);
+        quickSlotState.appendChild(slotState, nullptr);
+    }
+    return quickSlotState;
+}
+
+void PresetManager::setQuickSlotState(const ValueTree& quickSlotState)
+{
+    quickSlots = {};
+    for (const auto& slotState : quickSlotState)
+    {
+        const auto slot = static_cast<int>(slotState.getProperty("slot", -1));
+        if (isPositiveAndBelow(slot, numQuickSlots)){
+            quickSlots[slot] = { slotState.getProperty(presetNameProperty).toString(), decodeParameterValues(slotState) };
+        }
+    }
+}
+
+void PresetManager::processPendingPresets() noexcept
+{
+    presetHandoff.markBlockProcessed();
+    
+    // Broadcasts are always drained, so linking later doesn't pick up one that was sent before.
+    Parameters::Values values;
+    const auto broadcastId = presetBroadcast.receive(values);
+    if (broadcastId != 0 && linked.load(std::memory_order_relaxed))
+    {
+        applyParameterValuesFromAudioThread(values);
+        receivedBroadcast.store(broadcastId);
+    }
+    
+    // A preset chosen in this instance wins over a broadcast arriving in the same block.
+    const auto numHandedOff = presetHandoff.pop(values);
+    if (numHandedOff > 0)
+    {
+        applyParameterValuesFromAudioThread(values);
+        snapshotRef.endApply(numHandedOff);
+    }
+}
+
+int PresetManager::getNumPrograms()
+{
+    const auto table = std::atomic_load(&hostProgramTable);
+    return table != nullptr ? table->names.size() : storedProgramCount.load();
+}
+
+int PresetManager::getCurrentProgram()
+{
+    // A program that is still on its way to the message thread is already the current one for the host.
+    const auto program = requestedProgram.load();
+    return program >= 0 ? program : currentProgram.load();
+}
+
+String PresetManager::getProgramName(int index)
+{
+    const auto table = std::atomic_load(&hostProgramTable);
+    return table != nullptr ? table->names[index] : String();
+}
+
+void PresetManager::setCurrentProgram(int index)
+{
+    requestedProgram = index;
+    if (MessageManager::existsAndIsCurrentThread()){
+        applyRequestedProgram();
+    } else {
+        triggerAsyncUpdate();
+    }
+}
+
+void PresetManager::applyRequestedProgram()
+{
+    JUCE_ASSERT_MESSAGE_MANAGER_IS_LOCKED
+    
+    const auto index = requestedProgram.exchange(-1);
+    const auto* table = programTable.getLive();
+    if (table == nullptr || !isPositiveAndBelow(index, table->names.size())){
+        return;
+    }
+    
+    handOffParameterValues(table->entries[(size_t) index].values);
+    currentPreset = table->names[index];
+    currentProgram = index;
+}
+
+bool PresetManager::applyProgramFromAudioThread(int index) noexcept
+{
+    const ProgramTableHazard::ScopedRead table{ programTable };
+    const auto isValidProgram = table.get() != nullptr && isPositiveAndBelow(index, (int) table->entries.size());
+    if (isValidProgram)
+    {
+        applyParameterValuesFromAudioThread(table->entries[(size_t) index].values);
+        programChangedFromAudioThread.store(index);
+        currentProgram.store(index);
+    }
+    return isValidProgram;
+}
+
+void PresetManager::presetLibraryChanged()
+{
+    // The program table follows once the rescan has published a new snapshot.
+    if (catalogue != nullptr)
+    {
+        for (int layer = 0; layer < catalogue->getNumLayers(); ++layer)
+        {
+            if (catalogue->getLayer(layer).isWritable){
+                catalogue->invalidate(layer);
+            }
+        }
+        catalogue->scanInBackground();
+    }
+}
+
+void PresetManager::rebuildProgramTable()
+{
+    JUCE_ASSERT_MESSAGE_MANAGER_IS_LOCKED
+    
+    const auto table = catalogue != nullptr ? catalogue->getCachedSnapshot() : nullptr;
+    if (table == nullptr || table.get() == programTable.getLive()){
+        return;
+    }
+    
+    programTable.publish(table);
+    std::atomic_store(&hostProgramTable, table);
+    
+    updateCurrentProgram();
+    treeRef.processor.updateHostDisplay(AudioProcessorListener::ChangeDetails().withProgramChanged(true));
+    startPollingAudioThread();
+}
+
+void PresetManager::syncProgramChangedFromAudioThread()
+{
+    JUCE_ASSERT_MESSAGE_MANAGER_IS_LOCKED
+    
+    const auto program = programChangedFromAudioThread.exchange(-1);
+    if (program >= 0 && programTable.getLive() != nullptr){
+        currentPreset = programTable.getLive()->names[program];
+    }
+}
+
+void PresetManager::updateCurrentProgram()
+{
+    // Only looked up again when the preset or the table has changed, so that a program the audio thread
+    // has just switched to isn't overwritten before it has been synced here.
+    const auto* table = programTable.getLive();
+    if (table == currentProgramTable && currentPreset == currentProgramPresetName){
+        return;
+    }
+    
+    currentProgramTable = table;
+    currentProgramPresetName = currentPreset;
+    currentProgram = table != nullptr ? table->indexOf(currentPreset) : -1;
+}
+
 void PresetManager::valueTreeRedirected(ValueTree& treeWhichHasBeenChanged)
 {
     currentPreset = treeRef.state.getPropertyAsValue(presetNameProperty, nullptr).toString();
 }
+
+void PresetManager::handleAsyncUpdate()
+{
+    // A program the host asked for is applied before a new table can move the indices underneath it.
+    applyRequestedProgram();
+    
+    if (catalogueChanged.exchange(false))
+    {
+        rebuildProgramTable();
+        sendChangeMessage();
+    }
+}
+
+void PresetManager::timerCallback()
+{
+    const auto broadcastId = receivedBroadcast.exchange(0);
+    if (broadcastId != 0)
+    {
+        const auto presetName = presetBroadcast.getPresetName(broadcastId);
+        if (presetName.isNotEmpty())
+        {
+            currentPreset = presetName;
+            markStateReplaced();
+        }
+    }
+    
+    // However many presets the audio thread applied since the last tick, the host hears about it once.
+    if (hostDisplayUpdatePending.exchange(false))
+    {
+        syncProgramChangedFromAudioThread();
+        treeRef.processor.updateHostDisplay(AudioProcessorListener::ChangeDetails().withProgramChanged(true));
+    }
+    
+    updateCurrentProgram();
+    
+    // Once there are programs, a MIDI program change can be applied on the audio thread in any block, so
+    // the timer keeps running. Otherwise only a link or a preset still waiting for the audio thread can
+    // produce anything to pick up here.
+    const auto mayChangeOnAudioThread = linked.load() || presetHandoff.hasPending() || programTable.getLive() != nullptr;
+    if (!mayChangeOnAudioThread && !hostDisplayUpdatePending.load() && receivedBroadcast.load() == 0){
+        stopTimer();
+    }
+}
+
+void PresetManager::startPollingAudioThread()
+{
+    if (!isTimerRunning()){
+        startTimerHz(20);
+    }
+}
+
+LayeredPresetCatalogue& PresetManager::getCatalogue()
+{
+    if (catalogue == nullptr)
+    {
+        catalogue = std::make_unique<LayeredPresetCatalogue>(getLayers(), extension);
+        catalogue->onChange = [this]
+        {
+            catalogueChanged = true;
+            triggerAsyncUpdate();
+        };
+    }
+    return *catalogue;
+}
+
+PresetPack& PresetManager::getPresetPack()
+{
+    if (presetPack == nullptr){
+        presetPack = std::make_unique<PresetPack>();
+    }
+    return *presetPack;
+}
+
+PresetClusterer& PresetManager::getPresetClusterer()
+{
+    if (presetClusterer == nullptr){
+        presetClusterer = std::make_unique<PresetClusterer>();
+    }
+    return *presetClusterer;
+}
+
+void PresetManager::setLayers(std::vector<LayeredPresetCatalogue::Layer> layersToUse)
+{
+    // The catalogue is built from the layers the first time the library is used.
+    jassert(catalogue == nullptr);
+    if (catalogue == nullptr)
+    {
+        layers = std::move(layersToUse);
+        storedProgramCount = LayeredPresetCatalogue::readStoredEntryCount(layers, extension);
+    }
+}
+
+const std::vector<LayeredPresetCatalogue::Layer>& PresetManager::getLayers() const
+{
+    return layers.empty() ? getDefaultLayers() : layers;
+}
+
+const std::vector<LayeredPresetCatalogue::Layer>& PresetManager::getDefaultLayers()
+{
+    // The factory and shared directories are read-only, so their sidecars, and the group labels kept
+    // in them, live in the user's application data instead.
+    static const auto catalogueDirectory = File::getSpecialLocation(File::SpecialLocationType::userApplicationDataDirectory)
+        .getChildFile(ProjectInfo::companyName)
+        .getChildFile(ProjectInfo::projectName);
+    
+    static const std::vector<LayeredPresetCatalogue::Layer> defaultLayers{
+        { "Factory", getFactoryDirectory(), false, catalogueDirectory.getChildFile("Factory." + extension + "catalogue") },
+        { "Shared", getSharedDirectory(), false, catalogueDirectory.getChildFile("Shared." + extension + "catalogue") },
+        { "Legacy", getDefaultDirectory(), true },
+        { "User", getUserDirectory(), true }
+    };
+    return defaultLayers;
+}
+
+File PresetManager::getWritableDirectory() const
+{
+    const auto& layersInUse = getLayers();
+    for (auto layer = layersInUse.rbegin(); layer != layersInUse.rend(); ++layer)
+    {
+        if (layer->isWritable){
+            return layer->directory;
+        }
+    }
+    return {};
+}
+
+File PresetManager::getWritablePresetFile(const String& presetName) const
+{
+    return getWritableDirectory().getChildFile(presetName + "." + extension);
+}
+
+void PresetManager::writePresetState(const String& presetName, const ValueTree& state)
+{
+    const auto writableDirectory = getWritableDirectory();
+    if (!writableDirectory.exists())
+    {
+        const auto result = writableDirectory.createDirectory();
+        if (result.failed())
+        {
+            DBG("Could not create Preset Directory");
+            jassertfalse;
+            return;
+        }
+    }
+    
+    const auto xmlState = state.createXml();
+    if (!xmlState->writeTo(getWritablePresetFile(presetName)))
+    {
+        jassertfalse;
+    }
+}
+
+String PresetManager::getBasePresetName(const String& presetName)
+{
+    const auto entry = getCatalogueEntry(presetName);
+    return entry.has_value() ? entry->basePresetName : String();
+}
+
+bool PresetManager::isDerivedFrom(const String& presetName, const String& ancestorName)
+{
+    auto baseName = getBasePresetName(presetName);
+    for (int depth = 0; baseName.isNotEmpty(); ++depth)
+    {
+        if (baseName == ancestorName || depth >= maxDerivationDepth){
+            return true;
+        }
+        baseName = getBasePresetName(baseName);
+    }
+    return false;
+}
+
+void PresetManager::flattenPresetsDerivedFrom(const String& basePresetName)
+{
+    const auto snapshot = getCatalogue().getSnapshot();
+    
+    // Presets in read-only layers can't be rewritten.
+    for (const auto& entry : snapshot->entries)
+    {
+        if (entry.basePresetName == basePresetName && getCatalogue().getLayer(entry.layer).isWritable){
+            flattenPreset(entry.name);
+        }
+    }
+}
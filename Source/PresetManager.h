@@ -11,36 +11,294 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "Parameters.h"
+#include "ParameterSnapshot.h"
+#include "PresetHandoff.h"
+#include "HazardPointer.h"
+#include "LayeredPresetCatalogue.h"
+#include "PresetPack.h"
+#include "PresetBroadcast.h"
+#include "PresetClusterer.h"
 
-class PresetManager : ValueTree::Listener
+class PresetManager : public ChangeBroadcaster, ValueTree::Listener, AsyncUpdater, Timer
 {
 public:
-    PresetManager(AudioProcessorValueTreeState&);
+    PresetManager(AudioProcessorValueTreeState&, ParameterSnapshot&);
     
     ~PresetManager();
     
+    // With derived storage enabled, a preset saved from another one only stores the values that differ
+    // from it, and is resolved against it when loaded.
     void savePreset(const String& presetName);
     
+    void setDerivedStorageEnabled(bool shouldStoreDerived);
+    
+    bool isDerivedStorageEnabled() const;
+    
+    // Only presets in a writable layer can be deleted. Deleting one that overrides a preset in a lower
+    // layer reveals that one again.
     void deletePreset(const String& presetName);
     
+    bool canDeletePreset(const String& presetName);
+    
     void loadPreset(const String& presetName);
     
+    // Loads a preset here and sends it, already decoded, to every other linked instance.
+    void broadcastPreset(const String& presetName);
+    
+    // Linked instances apply presets broadcast by other instances, on their audio thread.
+    void setLinked(bool shouldBeLinked);
+    
+    bool isLinked() const;
+    
+    // Step through the library in the order the preset list shows it: group by group.
     int nextPreset();
     
     int previousPreset();
     
     StringArray getAllPresets();
+    
+    // Starts building the catalogue on a background thread, so that later calls don't wait on the disk.
+    // Broadcasts a change message when the preset library has been (re)built.
+    void prepareCatalogue();
+    
+    bool isCatalogueReady() const;
 
     String getCurrentPreset();
     
-    static const File defaultDirectory;
+    // Exports presets into one pack. Derived presets are either flattened into full presets, or exported
+    // as they are together with every base they depend on. Returns false if an import or export is
+    // already running.
+    bool exportPresetPack(const File& packFile, const StringArray& presetNames, bool flattenDerived,
+                          PresetPack::ProgressCallback onProgress, PresetPack::CompletionCallback onComplete);
+    
+    bool containsDerivedPresets(const StringArray& presetNames);
+    
+    // Imports a pack into the user's presets. Imported presets are added to the catalogue as they were
+    // decoded during the import, rather than being read back from disk.
+    bool importPresetPack(const File& packFile,
+                          PresetPack::ProgressCallback onProgress, PresetPack::CompletionCallback onComplete);
+    
+    bool isPresetPackBusy() const;
+    
+    // Groups the whole library by sound in the background and labels every preset with its group.
+    // Returns false if it is already running. Pass 0 clusters to choose from the library size.
+    bool clusterPresets(int numClusters = 0);
+    
+    bool isClustering() const;
+    
+    // The library grouped by label, in label order. Unlabelled presets are grouped under an empty label.
+    std::vector<std::pair<String, StringArray>> getPresetGroups();
+    
+    Parameters::Values decodeParameterValues(const ValueTree& state) const;
+    
+    // Resolves and decodes a preset without applying it.
+    std::optional<Parameters::Values> getPresetValues(const String& presetName);
+    
+    // Message thread: applies a preset as one host edit. Only parameters that actually move are touched, all
+    // their gestures open before any value changes, and the host display is updated once at the end.
+    void applyParameterValues(const Parameters::Values& values);
+    
+    // Audio thread: applies only the parameters that move, without gestures. The host display update is
+    // left to the message thread, which polls for it.
+    void applyParameterValuesFromAudioThread(const Parameters::Values& values) noexcept;
+    
+    // Restores a session. The host is loading this state itself, so there are no gestures or display updates.
+    // While audio runs, the parameters are set by the audio thread after any preset queued before, which
+    // then updates the host display as it does for those.
+    void restoreState(const ValueTree& state);
+    
+    // Bumped once whenever a whole state is applied, from any thread. Editors poll it on a timer and
+    // refresh once, instead of reacting to every parameter individually.
+    uint32 getStateGeneration() const noexcept;
+    
+    void markStateReplaced() noexcept;
+    
+    ValueTree createPresetState(const Parameters::Values& values) const;
+    
+    // Builds the current state from the parameter snapshot rather than copying the live ValueTree.
+    ValueTree createStateFromSnapshot();
+    
+    // The current parameter values as one consistent set. Every apply publishes the snapshot once it is
+    // complete, and presets handed to the audio thread are published as soon as they're queued, so this
+    // returns what was just set rather than waiting for the next block. Between applies, the audio thread
+    // refreshes it at the end of each block, or the caller does when audio isn't running.
+    Parameters::Values readParameterSnapshot() const noexcept;
+    
+    // Stores the current parameter values in a quick-slot, decoded and ready for instant recall.
+    void assignQuickSlot(int slot);
+    
+    void recallQuickSlot(int slot);
+    
+    bool isQuickSlotAssigned(int slot) const;
+    
+    String getQuickSlotPresetName(int slot) const;
+    
+    ValueTree getQuickSlotState() const;
+    
+    void setQuickSlotState(const ValueTree& quickSlotState);
+    
+    // Audio thread: applies presets handed over by the message thread. Call at the start of every block.
+    void processPendingPresets() noexcept;
+    
+    // The preset library exposed to the host as programs, in getAllPresets() order. Hosts may call these
+    // from any thread: the getters only read what the message thread last published, and setCurrentProgram()
+    // only records the index, which is applied straight away on the message thread and posted to it otherwise.
+    //
+    // Until the library has been scanned, the number of programs is the count the sidecars recorded last
+    // session. That can be too high where layers override each other, and is 0 the very first time the
+    // plugin runs. Hosts that only ask once, at construction, keep that count: names past the end of the
+    // library are empty and selecting them does nothing.
+    int getNumPrograms();
+    
+    int getCurrentProgram();
+    
+    String getProgramName(int index);
+    
+    void setCurrentProgram(int index);
+    
+    // Audio thread: applies a pre-decoded program straight away, without file I/O or allocation.
+    bool applyProgramFromAudioThread(int index) noexcept;
+    
+    static constexpr int numQuickSlots = 4;
+    static const Identifier quickSlotsType;
+    
+    // Resolved on first use. Presets are saved to the user directory, in the current account's documents.
+    // It overrides the default directory, the one presets were always saved to before, which is shared
+    // by every account on the machine. That overrides the shared team directory, which in turn overrides
+    // the read-only factory presets.
+    static const File& getUserDirectory();
+    
+    static const File& getDefaultDirectory();
+    
+    static const File& getSharedDirectory();
+    
+    static const File& getFactoryDirectory();
+    
+    // The factory, shared, default and user directories, in that order of precedence. Presets already
+    // in the default directory can still be deleted, but new ones only go to the user directory.
+    static const std::vector<LayeredPresetCatalogue::Layer>& getDefaultLayers();
+    
+    // Replaces the directories the library is read from and saved to, e.g. to point a test harness at a
+    // temporary folder. Only takes effect before anything has used the library.
+    void setLayers(std::vector<LayeredPresetCatalogue::Layer> layersToUse);
+    
+    // Where presets are saved to: the highest writable layer.
+    File getWritableDirectory() const;
+    
     static const String extension;
     static const String presetNameProperty;
+    static const String basePresetProperty;
+    static const String derivedStorageProperty;
 
     String currentPreset;
     
 private:
     void valueTreeRedirected(ValueTree& treeWhichHasBeenChanged) override; 
     
+    void handleAsyncUpdate() override;
+    
+    void timerCallback() override;
+    
+    // The normalised target of every parameter that differs from the values given; empty for the rest.
+    using ParameterChanges = std::array<std::optional<float>, Parameters::numParameters>;
+    
+    ParameterChanges getParameterChanges(const Parameters::Values& values) const noexcept;
+    
+    void saveDerivedPreset(const String& presetName, const String& basePresetName);
+    
+    // Rewrites a derived preset with its full state, so that it no longer depends on its base.
+    void flattenPreset(const String& presetName);
+    
+    // The full state of a catalogued preset, keeping everything else its file stores, like its group label.
+    ValueTree createFlattenedState(const PresetCatalogue::Entry& entry) const;
+    
+    LayeredPresetCatalogue& getCatalogue();
+    
+    std::optional<PresetCatalogue::Entry> getCatalogueEntry(const String& presetName);
+    
+    const std::vector<LayeredPresetCatalogue::Layer>& getLayers() const;
+    
+    // Every preset, flattened from getPresetGroups().
+    StringArray getPresetsInGroupOrder();
+    
+    PresetPack& getPresetPack();
+    
+    PresetClusterer& getPresetClusterer();
+    
+    File getWritablePresetFile(const String& presetName) const;
+    
+    void writePresetState(const String& presetName, const ValueTree& state);
+    
+    // Derivation is read from the catalogue, the same place loading resolves presets from.
+    String getBasePresetName(const String& presetName);
+    
+    bool isDerivedFrom(const String& presetName, const String& ancestorName);
+    
+    void flattenPresetsDerivedFrom(const String& basePresetName);
+    
+    static constexpr int maxDerivationDepth = 8;
+    
+    struct QuickSlot
+    {
+        String presetName;
+        std::optional<Parameters::Values> values;
+    };
+    
+    std::array<QuickSlot, numQuickSlots> quickSlots;
+    PresetHandoff presetHandoff;
+    
+    // Programs are served straight from catalogue snapshots.
+    using ProgramTable = PresetCatalogue::Snapshot;
+    
+    void presetLibraryChanged();
+    
+    // Message thread only.
+    void rebuildProgramTable();
+    
+    void syncProgramChangedFromAudioThread();
+    
+    void updateCurrentProgram();
+    
+    void applyRequestedProgram();
+    
+    // The timer picks up what the audio thread applied. It only runs while something can make the audio
+    // thread apply a preset, and stops itself once nothing can.
+    void startPollingAudioThread();
+    
+    // Queues values for the audio thread to apply when it's running, and applies them here otherwise.
+    void handOffParameterValues(const Parameters::Values& values);
+    
+    // Returns false, leaving the values to the caller, if audio isn't running or the queue is full.
+    bool queueForAudioThread(const Parameters::Values& values);
+    
+    // Tables are only freed on the message thread once the audio thread has stopped using them.
+    using ProgramTableHazard = HazardPointer<const ProgramTable>;
+    ProgramTableHazard programTable;
+    std::atomic<int> programChangedFromAudioThread{ -1 };
+    
+    // What host threads read. A shared pointer, since they have no hazard slot of their own.
+    std::shared_ptr<const ProgramTable> hostProgramTable;
+    std::atomic<int> currentProgram{ -1 };
+    std::atomic<int> requestedProgram{ -1 };
+    std::atomic<int> storedProgramCount{ 0 };
+    std::atomic<bool> catalogueChanged{ false };
+    const ProgramTable* currentProgramTable = nullptr;
+    String currentProgramPresetName;
+    std::atomic<bool> hostDisplayUpdatePending{ false };
+    
+    PresetBroadcast presetBroadcast;
+    std::atomic<bool> linked{ false };
+    std::atomic<uint64> receivedBroadcast{ 0 };
+    std::atomic<uint32> stateGeneration{ 0 };
+    
+    std::vector<LayeredPresetCatalogue::Layer> layers;
+    std::unique_ptr<LayeredPresetCatalogue> catalogue;
+    std::unique_ptr<PresetPack> presetPack;
+    std::unique_ptr<PresetClusterer> presetClusterer;
+    std::atomic<bool> derivedStorageEnabled{ false };
+    
     AudioProcessorValueTreeState& treeRef;
+    ParameterSnapshot& snapshotRef;
+    std::array<RangedAudioParameter*, Parameters::numParameters> parameters;
 };
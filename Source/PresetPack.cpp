@@ -0,0 +1,430 @@
+/*
+  ==============================================================================
+
+    PresetPack.cpp
+    Created: 19 Oct 2026 6:46:47am
+
+  ==============================================================================
+*/
+
+#include "PresetPack.h"
+
+const String PresetPack::extension{ "presetpack" };
+
+PresetPack::PresetPack(int numThreads)
+    : Thread("Preset pack"), threadPool(numThreads), maxBatchesInFlight(jmax(2, numThreads * 2))
+{
+}
+
+PresetPack::~PresetPack()
+{
+    cancel();
+    stopThread(10000);
+    threadPool.removeAllJobs(true, 5000);
+}
+
+bool PresetPack::exportPack(std::vector<ExportItem> presets, const File& packFile,
+                            ProgressCallback onProgress, CompletionCallback onComplete)
+{
+    return start([this, presets = std::move(presets), packFile]
+    {
+        return writePack(presets, packFile);
+    }, std::move(onProgress), std::move(onComplete));
+}
+
+bool PresetPack::importPack(const File& packFile, const File& destinationDirectory, const String& presetExtension,
+                            IndexCallback onIndexed, ProgressCallback onProgress, CompletionCallback onComplete)
+{
+    return start([this, packFile, destinationDirectory, presetExtension, onIndexed = std::move(onIndexed)]
+    {
+        return readPack(packFile, destinationDirectory, presetExtension, onIndexed);
+    }, std::move(onProgress), std::move(onComplete));
+}
+
+bool PresetPack::isBusy() const
+{
+    return isThreadRunning();
+}
+
+void PresetPack::cancel()
+{
+    isCancelled = true;
+    signalThreadShouldExit();
+}
+
+bool PresetPack::start(std::function<Result()> taskToRun, ProgressCallback onProgress, CompletionCallback onComplete)
+{
+    if (isThreadRunning()){
+        return false;
+    }
+    
+    task = std::move(taskToRun);
+    completionCallback = std::move(onComplete);
+    progress = std::make_shared<Progress>();
+    progress->callback = std::move(onProgress);
+    isCancelled = false;
+    return startThread();
+}
+
+void PresetPack::run()
+{
+    const auto result = task();
+    
+    if (completionCallback != nullptr)
+    {
+        MessageManager::callAsync([callback = completionCallback, result]
+        {
+            callback(result);
+        });
+    }
+}
+
+Result PresetPack::writePack(const std::vector<ExportItem>& presets, const File& packFile)
+{
+    TemporaryFile temporaryFile{ packFile };
+    const auto numTotal = (int) presets.size();
+    int numWritten = 0;
+    int numFailed = 0;
+    
+    {
+        FileOutputStream output{ temporaryFile.getFile() };
+        if (output.failedToOpen()){
+            return Result::fail("Could not write to " + packFile.getFullPathName());
+        }
+        
+        output.writeInt(packMagic);
+        output.writeInt(packFormatVersion);
+        const auto countPosition = output.getPosition();
+        output.writeInt(0);
+        
+        std::deque<std::shared_ptr<Batch>> batchesInFlight;
+        size_t nextPreset = 0;
+        
+        while (!threadShouldExit() && (nextPreset < presets.size() || !batchesInFlight.empty()))
+        {
+            while (nextPreset < presets.size() && (int) batchesInFlight.size() < maxBatchesInFlight)
+            {
+                auto batch = std::make_shared<Batch>();
+                const auto batchEnd = jmin(presets.size(), nextPreset + (size_t) batchSize);
+                batch->presets.assign(presets.begin() + (std::ptrdiff_t) nextPreset, presets.begin() + (std::ptrdiff_t) batchEnd);
+                nextPreset = batchEnd;
+                
+                threadPool.addJob([this, batch]
+                {
+                    compressBatch(*batch);
+                    batch->finished.signal();
+                });
+                batchesInFlight.push_back(std::move(batch));
+            }
+            
+            // Batches are written in the order they were queued, whichever finishes first.
+            const auto batch = batchesInFlight.front();
+            batchesInFlight.pop_front();
+            batch->finished.wait();
+            
+            for (const auto& packed : batch->packed)
+            {
+                output.writeString(packed.name);
+                output.writeInt64(packed.size);
+                output.writeInt64((int64) packed.contentHash);
+                output.writeInt64((int64) packed.data.getSize());
+                output.write(packed.data.getData(), packed.data.getSize());
+            }
+            
+            numWritten += (int) batch->packed.size();
+            numFailed += batch->numFailed;
+            reportProgress(numWritten + numFailed, numTotal);
+        }
+        
+        for (const auto& batch : batchesInFlight){
+            batch->finished.wait();
+        }
+        
+        if (threadShouldExit()){
+            return Result::fail("Export cancelled");
+        }
+        
+        // The count is only known once every preset has been read.
+        output.setPosition((int64) countPosition);
+        output.writeInt(numWritten);
+        output.flush();
+        
+        if (output.getStatus().failed()){
+            return Result::fail("Could not write to " + packFile.getFullPathName());
+        }
+    }
+    
+    if (!temporaryFile.overwriteTargetFileWithTemporary()){
+        return Result::fail("Could not write to " + packFile.getFullPathName());
+    }
+    
+    if (numFailed > 0){
+        return Result::fail(String(numFailed) + " presets could not be read and were left out");
+    }
+    return Result::ok();
+}
+
+Result PresetPack::readPack(const File& packFile, const File& destinationDirectory, const String& presetExtension,
+                            const IndexCallback& onIndexed)
+{
+    FileInputStream fileInput{ packFile };
+    if (fileInput.failedToOpen()){
+        return Result::fail("Could not open " + packFile.getFullPathName());
+    }
+    
+    BufferedInputStream input{ fileInput, 1 << 16 };
+    if (input.readInt() != packMagic || input.readInt() != packFormatVersion){
+        return Result::fail(packFile.getFileName() + " is not a preset pack");
+    }
+    
+    const auto numTotal = input.readInt();
+    if (numTotal < 0){
+        return Result::fail(packFile.getFileName() + " is damaged");
+    }
+    
+    if (!destinationDirectory.isDirectory() && destinationDirectory.createDirectory().failed()){
+        return Result::fail("Could not create " + destinationDirectory.getFullPathName());
+    }
+    
+    // Every name is settled in a first pass over the headers, before any batch is handed out. That way no
+    // two workers ever write the same file, and a derived preset's base is known under its final name
+    // even when the base comes later in the pack.
+    const auto dataStart = input.getPosition();
+    std::vector<uint64> contentHashes;
+    const auto packedNames = readPackedNames(input, numTotal, contentHashes);
+    auto isDamaged = false;
+    
+    if (!input.setPosition(dataStart)){
+        return Result::fail("Could not read " + packFile.getFullPathName());
+    }
+    
+    // Case is ignored, as it is by most of the filesystems presets live on.
+    StringArray importedNames;
+    RenameMap renamedPresets;
+    std::set<String> usedNames;
+    for (int index = 0; index < packedNames.size(); ++index)
+    {
+        const auto legalName = File::createLegalFileName(packedNames[index]);
+        auto name = legalName;
+        for (int suffix = 2; legalName.isNotEmpty(); ++suffix)
+        {
+            const auto existingFile = destinationDirectory.getChildFile(name + "." + presetExtension);
+            MemoryBlock existingContent;
+            const auto isTakenOnDisk = existingFile.existsAsFile()
+                                    && !(existingFile.loadFileAsData(existingContent)
+                                         && PresetCatalogue::hashContent(existingContent.getData(), existingContent.getSize()) == contentHashes[(size_t) index]);
+            
+            if (!isTakenOnDisk && usedNames.insert(name.toLowerCase()).second){
+                break;
+            }
+            name = legalName + " (" + String(suffix) + ")";
+        }
+        
+        // Where a name appears more than once, references to it mean the first preset with that name.
+        if (name != packedNames[index] && renamedPresets.count(packedNames[index]) == 0){
+            renamedPresets[packedNames[index]] = name;
+        }
+        importedNames.add(name);
+    }
+    
+    std::deque<std::shared_ptr<Batch>> batchesInFlight;
+    std::vector<PresetCatalogue::Entry> imported;
+    const auto numToRead = importedNames.size();
+    int numRead = 0;
+    int numImported = 0;
+    int numFailed = 0;
+    
+    while (!threadShouldExit() && ((numRead < numToRead && !isDamaged) || !batchesInFlight.empty()))
+    {
+        while (numRead < numToRead && !isDamaged && (int) batchesInFlight.size() < maxBatchesInFlight)
+        {
+            auto batch = std::make_shared<Batch>();
+            for (int index = 0; index < batchSize && numRead < numToRead; ++index, ++numRead)
+            {
+                PackedEntry packed;
+                input.readString();
+                packed.name = importedNames[numRead];
+                packed.size = input.readInt64();
+                packed.contentHash = (uint64) input.readInt64();
+                const auto compressedSize = input.readInt64();
+                
+                // Sizes are checked before allocating, so a damaged pack can't ask for unbounded memory.
+                if (packed.size < 0 || packed.size > maxPresetSize
+                    || compressedSize < 0 || compressedSize > maxPresetSize
+                    || compressedSize > input.getNumBytesRemaining())
+                {
+                    isDamaged = true;
+                    break;
+                }
+                
+                packed.data.setSize((size_t) compressedSize);
+                if (input.read(packed.data.getData(), (int) compressedSize) != (int) compressedSize)
+                {
+                    isDamaged = true;
+                    break;
+                }
+                batch->packed.push_back(std::move(packed));
+            }
+            
+            threadPool.addJob([this, batch, destinationDirectory, presetExtension, &renamedPresets]
+            {
+                expandBatch(*batch, destinationDirectory, presetExtension, renamedPresets);
+                batch->finished.signal();
+            });
+            batchesInFlight.push_back(std::move(batch));
+        }
+        
+        if (batchesInFlight.empty()){
+            break;
+        }
+        
+        const auto batch = batchesInFlight.front();
+        batchesInFlight.pop_front();
+        batch->finished.wait();
+        
+        numImported += (int) batch->entries.size();
+        numFailed += batch->numFailed;
+        std::move(batch->entries.begin(), batch->entries.end(), std::back_inserter(imported));
+        reportProgress(numImported + numFailed, numTotal);
+    }
+    
+    for (const auto& batch : batchesInFlight){
+        batch->finished.wait();
+    }
+    
+    // Whatever made it to disk is indexed, even if the import was cut short.
+    if (onIndexed != nullptr && !imported.empty()){
+        onIndexed(std::move(imported));
+    }
+    
+    if (threadShouldExit()){
+        return Result::fail("Import cancelled after " + String(numImported) + " presets");
+    }
+    if (isDamaged || numToRead < numTotal){
+        return Result::fail(packFile.getFileName() + " is damaged. " + String(numImported) + " presets were imported");
+    }
+    if (numFailed > 0){
+        return Result::fail(String(numFailed) + " presets in " + packFile.getFileName() + " were invalid and were skipped");
+    }
+    return Result::ok();
+}
+
+StringArray PresetPack::readPackedNames(InputStream& input, int numTotal, std::vector<uint64>& contentHashes)
+{
+    StringArray names;
+    for (int index = 0; index < numTotal; ++index)
+    {
+        const auto name = input.readString();
+        const auto size = input.readInt64();
+        const auto contentHash = (uint64) input.readInt64();
+        const auto compressedSize = input.readInt64();
+        
+        if (size < 0 || size > maxPresetSize
+            || compressedSize < 0 || compressedSize > maxPresetSize
+            || compressedSize > input.getNumBytesRemaining()
+            || !input.setPosition(input.getPosition() + compressedSize))
+        {
+            break;
+        }
+        
+        names.add(name);
+        contentHashes.push_back(contentHash);
+    }
+    return names;
+}
+
+void PresetPack::compressBatch(Batch& batch) const
+{
+    for (const auto& preset : batch.presets)
+    {
+        if (isCancelled.load()){
+            return;
+        }
+        
+        MemoryBlock content{ preset.content };
+        if ((content.isEmpty() && !preset.file.loadFileAsData(content)) || (int64) content.getSize() > maxPresetSize)
+        {
+            ++batch.numFailed;
+            continue;
+        }
+        
+        MemoryOutputStream compressed;
+        {
+            GZIPCompressorOutputStream compressor{ compressed, 9 };
+            compressor.write(content.getData(), content.getSize());
+        }
+        
+        batch.packed.push_back({ preset.name, (int64) content.getSize(),
+                                 PresetCatalogue::hashContent(content.getData(), content.getSize()),
+                                 compressed.getMemoryBlock() });
+    }
+}
+
+void PresetPack::expandBatch(Batch& batch, const File& destinationDirectory, const String& presetExtension,
+                             const RenameMap& renamedPresets) const
+{
+    for (const auto& packed : batch.packed)
+    {
+        if (isCancelled.load()){
+            return;
+        }
+        
+        MemoryInputStream compressed{ packed.data, false };
+        GZIPDecompressorInputStream decompressor{ compressed };
+        MemoryBlock content;
+        decompressor.readIntoMemoryBlock(content, (ssize_t) maxPresetSize);
+        
+        PresetCatalogue::Entry entry;
+        entry.name = packed.name;
+        
+        auto isValid = entry.name.isNotEmpty()
+                    && (int64) content.getSize() == packed.size
+                    && PresetCatalogue::hashContent(content.getData(), content.getSize()) == packed.contentHash
+                    && PresetCatalogue::decodeEntry(entry, content);
+        
+        // The base was imported under another name, so the reference to it follows. The content has been
+        // verified by now, and the entry is decoded again from what is actually written.
+        const auto renamedBase = renamedPresets.find(entry.basePresetName);
+        if (isValid && entry.basePresetName.isNotEmpty() && renamedBase != renamedPresets.end())
+        {
+            auto xmlState = XmlDocument::parse(content.toString());
+            xmlState->setAttribute("basePreset", renamedBase->second);
+            const auto rewritten = xmlState->toString();
+            content.replaceAll(rewritten.toRawUTF8(), rewritten.getNumBytesAsUTF8());
+            
+            entry = {};
+            entry.name = packed.name;
+            isValid = PresetCatalogue::decodeEntry(entry, content);
+        }
+        
+        entry.file = destinationDirectory.getChildFile(entry.name + "." + presetExtension);
+        if (!isValid || !entry.file.replaceWithData(content.getData(), content.getSize()))
+        {
+            ++batch.numFailed;
+            continue;
+        }
+        
+        entry.relativePath = entry.file.getFileName();
+        entry.lastModified = entry.file.getLastModificationTime();
+        entry.size = entry.file.getSize();
+        batch.entries.push_back(std::move(entry));
+    }
+}
+
+void PresetPack::reportProgress(int numDone, int numTotal)
+{
+    progress->numDone = numDone;
+    progress->numTotal = numTotal;
+    
+    // A 100k preset import would otherwise flood the message queue. At most one update waits at a time,
+    // and it reports the latest counts when it arrives.
+    if (progress->callback == nullptr || progress->isUpdatePending.exchange(true)){
+        return;
+    }
+    
+    MessageManager::callAsync([progress = progress]
+    {
+        progress->isUpdatePending = false;
+        progress->callback(progress->numDone.load(), progress->numTotal.load());
+    });
+}
@@ -0,0 +1,123 @@
+/*
+  ==============================================================================
+
+    PresetPack.h
+    Created: 19 Oct 2026 6:46:47am
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "PresetCatalogue.h"
+
+// Moves whole preset libraries in and out of a single archive. Every preset is compressed on its own,
+// so exporting compresses batches on all cores while one thread streams them out in order, and
+// importing decompresses, validates and decodes batches in parallel while the archive is still being
+// read. At most a few batches are in flight, so neither side holds the whole archive in memory.
+//
+// One import or export runs at a time. Progress and completion are reported on the message thread.
+class PresetPack : private Thread
+{
+public:
+    explicit PresetPack(int numThreads = SystemStats::getNumCpus());
+    
+    ~PresetPack() override;
+    
+    using ProgressCallback = std::function<void(int numDone, int numTotal)>;
+    using CompletionCallback = std::function<void(const Result& result)>;
+    
+    // Called on the import thread with every preset that was imported, already decoded.
+    using IndexCallback = std::function<void(std::vector<PresetCatalogue::Entry>&& entries)>;
+    
+    // A preset to export. It is read from its file unless its content is given, e.g. for a derived preset
+    // that was flattened for the export.
+    struct ExportItem
+    {
+        String name;
+        File file;
+        MemoryBlock content;
+    };
+    
+    // Returns false if another import or export is still running.
+    bool exportPack(std::vector<ExportItem> presets, const File& packFile,
+                    ProgressCallback onProgress, CompletionCallback onComplete);
+    
+    // Writes every valid preset in the pack into the destination directory. A preset is never overwritten:
+    // an imported one whose name is taken, by a preset already there or by an earlier one in the pack, is
+    // given a numbered name, unless it is identical to the existing file. Derived presets whose base was
+    // renamed are rewritten to refer to it under its new name.
+    bool importPack(const File& packFile, const File& destinationDirectory, const String& presetExtension,
+                    IndexCallback onIndexed, ProgressCallback onProgress, CompletionCallback onComplete);
+    
+    bool isBusy() const;
+    
+    void cancel();
+    
+    static const String extension;
+    
+private:
+    struct PackedEntry
+    {
+        String name;
+        int64 size = 0;
+        uint64 contentHash = 0;
+        MemoryBlock data;
+    };
+    
+    struct Batch
+    {
+        std::vector<ExportItem> presets;
+        std::vector<PackedEntry> packed;
+        std::vector<PresetCatalogue::Entry> entries;
+        int numFailed = 0;
+        WaitableEvent finished{ true };
+    };
+    
+    struct Progress
+    {
+        ProgressCallback callback;
+        std::atomic<int> numDone{ 0 };
+        std::atomic<int> numTotal{ 0 };
+        std::atomic<bool> isUpdatePending{ false };
+    };
+    
+    void run() override;
+    
+    bool start(std::function<Result()> taskToRun, ProgressCallback onProgress, CompletionCallback onComplete);
+    
+    Result writePack(const std::vector<ExportItem>& presets, const File& packFile);
+    
+    Result readPack(const File& packFile, const File& destinationDirectory, const String& presetExtension,
+                    const IndexCallback& onIndexed);
+    
+    void compressBatch(Batch& batch) const;
+    
+    // Maps names in the pack to the names their presets were imported under, for those that had to change.
+    using RenameMap = std::map<String, String>;
+    
+    // Reads every entry's header, skipping the compressed data. Returns the names in pack order, and stops
+    // early at the first damaged entry.
+    static StringArray readPackedNames(InputStream& input, int numTotal, std::vector<uint64>& contentHashes);
+    
+    void expandBatch(Batch& batch, const File& destinationDirectory, const String& presetExtension,
+                     const RenameMap& renamedPresets) const;
+    
+    void reportProgress(int numDone, int numTotal);
+    
+    static constexpr int packMagic = 0x4b504d50;
+    static constexpr int packFormatVersion = 1;
+    static constexpr int batchSize = 64;
+    static constexpr int64 maxPresetSize = 16 * 1024 * 1024;
+    
+    ThreadPool threadPool;
+    const int maxBatchesInFlight;
+    
+    std::function<Result()> task;
+    CompletionCallback completionCallback;
+    std::shared_ptr<Progress> progress;
+    std::atomic<bool> isCancelled{ false };
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PresetPack);
+};
@@ -12,11 +12,14 @@
 
 #include <JuceHeader.h>
 
-class PresetPanel : public Component, Button::Listener, ComboBox::Listener
+class PresetPanel : public Component, Button::Listener, ComboBox::Listener, ChangeListener, Timer
 {
 public:
-    PresetPanel(PresetManager& pm) : presetManager(pm)
+    PresetPanel(PresetManager& pm, PreviewPlayer& player) : presetManager(pm), previewPlayer(player)
     {
+        presetManager.addChangeListener(this);
+        presetManager.prepareCatalogue();
+        
         saveButton.setButtonText("Save");
         addAndMakeVisible(saveButton);
         saveButton.addListener(this);
@@ -25,6 +28,39 @@ public:
         addAndMakeVisible(deleteButton);
         deleteButton.addListener(this);
         
+        importButton.setButtonText("Import");
+        addAndMakeVisible(importButton);
+        importButton.addListener(this);
+        
+        exportButton.setButtonText("Export");
+        addAndMakeVisible(exportButton);
+        exportButton.addListener(this);
+        
+        linkButton.setButtonText("Link");
+        linkButton.setTooltip("Linked instances follow each other's preset changes");
+        linkButton.setClickingTogglesState(true);
+        linkButton.setToggleState(presetManager.isLinked(), dontSendNotification);
+        addAndMakeVisible(linkButton);
+        linkButton.addListener(this);
+        
+        deriveButton.setButtonText("Derive");
+        deriveButton.setTooltip("Save presets as changes to the preset they were made from");
+        deriveButton.setClickingTogglesState(true);
+        deriveButton.setToggleState(presetManager.isDerivedStorageEnabled(), dontSendNotification);
+        addAndMakeVisible(deriveButton);
+        deriveButton.addListener(this);
+        
+        auditionButton.setButtonText("Audition");
+        auditionButton.setTooltip("Hear presets from the list without loading them");
+        auditionButton.setClickingTogglesState(true);
+        addAndMakeVisible(auditionButton);
+        auditionButton.addListener(this);
+        
+        groupButton.setButtonText("Group");
+        groupButton.setTooltip("Sort the library into groups of similar presets");
+        addAndMakeVisible(groupButton);
+        groupButton.addListener(this);
+        
         nextButton.setButtonText(">>");
         addAndMakeVisible(nextButton);
         nextButton.addListener(this);
@@ -37,16 +73,41 @@ public:
         addAndMakeVisible(presetList);
         presetList.addListener(this);
         
-        loadPresetList();
+        for (int slot = 0; slot < PresetManager::numQuickSlots; ++slot)
+        {
+            auto& quickSlotButton = quickSlotButtons[slot];
+            quickSlotButton.setButtonText(String::charToString(static_cast<juce_wchar>('A' + slot)));
+            quickSlotButton.setClickingTogglesState(false);
+            addAndMakeVisible(quickSlotButton);
+            quickSlotButton.addListener(this);
+        }
+        
+        // The list fills in when the background scan finishes, so opening the editor never waits on the disk.
+        if (presetManager.isCatalogueReady())
+            loadPresetList();
+        updateQuickSlotButtons();
+        
+        displayedStateGeneration = presetManager.getStateGeneration();
+        startTimerHz(30);
     }
     
     ~PresetPanel()
     {
+        previewPlayer.stop();
+        presetManager.removeChangeListener(this);
         saveButton.removeListener(this);
         deleteButton.removeListener(this);
+        importButton.removeListener(this);
+        exportButton.removeListener(this);
+        linkButton.removeListener(this);
+        deriveButton.removeListener(this);
+        auditionButton.removeListener(this);
+        groupButton.removeListener(this);
         previousButton.removeListener(this);
         nextButton.removeListener(this);
         presetList.removeListener(this);
+        for (auto& quickSlotButton : quickSlotButtons)
+            quickSlotButton.removeListener(this);
     }
     
 private:
@@ -56,7 +117,7 @@ private:
         {
             fileChooser = std::make_unique<FileChooser>(
                 "Please enter the name of the preset to save",
-                PresetManager::defaultDirectory,
+                presetManager.getWritableDirectory(),
                 "*." + PresetManager::extension
             );
             fileChooser->launchAsync(FileBrowserComponent::saveMode, [&](const FileChooser& chooser){
@@ -69,14 +130,14 @@ private:
         
         if (button == &previousButton)
         {
-            const auto index = presetManager.previousPreset();
-            presetList.setSelectedItemIndex(index, dontSendNotification);
+            presetManager.previousPreset();
+            selectCurrentPreset();
         }
         
         if (button == &nextButton)
         {
-            const auto index = presetManager.nextPreset();
-            presetList.setSelectedItemIndex(index, dontSendNotification);
+            presetManager.nextPreset();
+            selectCurrentPreset();
         }
         
         if (button == &deleteButton)
@@ -85,13 +146,123 @@ private:
             loadPresetList();
         }
         
+        // The list regroups itself once the new labels reach the catalogue.
+        if (button == &groupButton)
+        {
+            presetManager.clusterPresets();
+        }
+        
+        if (button == &linkButton)
+        {
+            presetManager.setLinked(linkButton.getToggleState());
+        }
+        
+        if (button == &deriveButton)
+        {
+            presetManager.setDerivedStorageEnabled(deriveButton.getToggleState());
+        }
+        
+        if (button == &auditionButton)
+        {
+            setAuditioning(auditionButton.getToggleState());
+        }
+        
+        if (button == &importButton)
+        {
+            fileChooser = std::make_unique<FileChooser>(
+                "Choose a preset pack to import",
+                File::getSpecialLocation(File::SpecialLocationType::userDocumentsDirectory),
+                "*." + PresetPack::extension
+            );
+            fileChooser->launchAsync(FileBrowserComponent::openMode | FileBrowserComponent::canSelectFiles, [&](const FileChooser& chooser){
+                const auto packFile = chooser.getResult();
+                if (packFile.existsAsFile())
+                    startPresetPackTransfer(importButton, presetManager.importPresetPack(packFile, makeProgressCallback(importButton), makeCompletionCallback()));
+            });
+        }
+        
+        if (button == &exportButton)
+        {
+            fileChooser = std::make_unique<FileChooser>(
+                "Please enter the name of the preset pack to export",
+                File::getSpecialLocation(File::SpecialLocationType::userDocumentsDirectory),
+                "*." + PresetPack::extension
+            );
+            fileChooser->launchAsync(FileBrowserComponent::saveMode | FileBrowserComponent::warnAboutOverwriting, [&](const FileChooser& chooser){
+                const auto packFile = chooser.getResult();
+                if (packFile == File())
+                    return;
+                
+                const auto presetNames = presetManager.getAllPresets();
+                if (!presetManager.containsDerivedPresets(presetNames))
+                {
+                    exportPresetPack(packFile, presetNames, false);
+                    return;
+                }
+                
+                // Flattened presets load anywhere on their own; derived ones stay small and keep following
+                // their bases.
+                AlertWindow::showOkCancelBox(MessageBoxIconType::QuestionIcon, "Export Preset Pack",
+                                             "Some of these presets are stored relative to another preset. "
+                                             "Flatten them into full presets, or export them as they are?",
+                                             "Flatten", "Keep Derived", this,
+                                             ModalCallbackFunction::create([safeThis = SafePointer<PresetPanel>(this), packFile, presetNames](int result)
+                {
+                    if (safeThis != nullptr)
+                        safeThis->exportPresetPack(packFile, presetNames, result != 0);
+                }));
+            });
+        }
+        
+        for (int slot = 0; slot < PresetManager::numQuickSlots; ++slot)
+        {
+            if (button != &quickSlotButtons[slot])
+                continue;
+            
+            // Shift-click (or clicking an empty slot) stores the current sound; a plain click recalls it.
+            if (ModifierKeys::currentModifiers.isShiftDown() || !presetManager.isQuickSlotAssigned(slot))
+            {
+                presetManager.assignQuickSlot(slot);
+                updateQuickSlotButtons();
+            }
+            else
+            {
+                presetManager.recallQuickSlot(slot);
+                selectCurrentPreset();
+            }
+        }
+        
+    }
+    
+    void timerCallback() override
+    {
+        // However many parameters a preset change touched, the panel refreshes once.
+        const auto stateGeneration = presetManager.getStateGeneration();
+        if (stateGeneration == displayedStateGeneration)
+            return;
+        
+        displayedStateGeneration = stateGeneration;
+        selectCurrentPreset();
+        deriveButton.setToggleState(presetManager.isDerivedStorageEnabled(), dontSendNotification);
+        updateQuickSlotButtons();
+    }
+    
+    void changeListenerCallback(ChangeBroadcaster*) override
+    {
+        loadPresetList();
     }
     
     void comboBoxChanged(ComboBox* comboBoxThatHasChanged) override
     {
         if (comboBoxThatHasChanged == &presetList)
         {
-            presetManager.loadPreset(presetList.getItemText(presetList.getSelectedItemIndex()));
+            const auto presetName = presetList.getItemText(presetList.getSelectedItemIndex());
+            if (auditionButton.getToggleState())
+                auditionPreset(presetName);
+            else if (presetManager.isLinked())
+                presetManager.broadcastPreset(presetName);
+            else
+                presetManager.loadPreset(presetName);
         }
         
     }
@@ -101,28 +272,173 @@ private:
         const auto container = getLocalBounds().reduced(4);
         auto bounds  = container;
         
-        saveButton.setBounds(bounds.removeFromLeft(container.proportionOfWidth(0.2)).reduced(4));
-        nextButton.setBounds(bounds.removeFromLeft(container.proportionOfWidth(0.1)).reduced(4));
-        presetList.setBounds(bounds.removeFromLeft(container.proportionOfWidth(0.4)).reduced(4));
-        previousButton.setBounds(bounds.removeFromLeft(container.proportionOfWidth(0.1)).reduced(4));
-        deleteButton.setBounds(bounds.removeFromLeft(container.proportionOfWidth(0.2)).reduced(4));
+        saveButton.setBounds(bounds.removeFromLeft(container.proportionOfWidth(0.07)).reduced(4));
+        nextButton.setBounds(bounds.removeFromLeft(container.proportionOfWidth(0.05)).reduced(4));
+        presetList.setBounds(bounds.removeFromLeft(container.proportionOfWidth(0.18)).reduced(4));
+        previousButton.setBounds(bounds.removeFromLeft(container.proportionOfWidth(0.05)).reduced(4));
+        deleteButton.setBounds(bounds.removeFromLeft(container.proportionOfWidth(0.07)).reduced(4));
+        importButton.setBounds(bounds.removeFromLeft(container.proportionOfWidth(0.07)).reduced(4));
+        exportButton.setBounds(bounds.removeFromLeft(container.proportionOfWidth(0.07)).reduced(4));
+        linkButton.setBounds(bounds.removeFromLeft(container.proportionOfWidth(0.06)).reduced(4));
+        deriveButton.setBounds(bounds.removeFromLeft(container.proportionOfWidth(0.07)).reduced(4));
+        auditionButton.setBounds(bounds.removeFromLeft(container.proportionOfWidth(0.07)).reduced(4));
+        groupButton.setBounds(bounds.removeFromLeft(container.proportionOfWidth(0.06)).reduced(4));
+        
+        for (auto& quickSlotButton : quickSlotButtons)
+            quickSlotButton.setBounds(bounds.removeFromLeft(container.proportionOfWidth(0.045)).reduced(2));
     }
     
     void loadPresetList()
     {
         presetList.clear(dontSendNotification);
-        const auto allPresets = presetManager.getAllPresets();
+        
+        // Grouped libraries get a heading per group; until then it's one flat list.
+        auto itemId = 1;
+        for (const auto& [groupName, presetNames] : presetManager.getPresetGroups())
+        {
+            if (groupName.isNotEmpty())
+                presetList.addSectionHeading(groupName);
+            
+            for (const auto& presetName : presetNames)
+                presetList.addItem(presetName, itemId++);
+        }
+        selectCurrentPreset();
+    }
+    
+    void selectCurrentPreset()
+    {
         const auto currentPreset = presetManager.getCurrentPreset();
-        presetList.addItemList(allPresets, 1);
-        presetList.setSelectedItemIndex(allPresets.indexOf(currentPreset), dontSendNotification);
+        
+        // Factory and shared presets can't be deleted from here.
+        deleteButton.setEnabled(presetManager.canDeletePreset(currentPreset));
+        
+        for (int index = 0; index < presetList.getNumItems(); ++index)
+        {
+            if (presetList.getItemText(index) == currentPreset)
+            {
+                presetList.setSelectedItemIndex(index, dontSendNotification);
+                return;
+            }
+        }
+        presetList.setSelectedId(0, dontSendNotification);
+    }
+    
+    void setAuditioning(bool shouldAudition)
+    {
+        if (!shouldAudition)
+        {
+            // Leaving audition mode keeps whatever was picked last.
+            previewPlayer.stop();
+            if (auditioner != nullptr)
+                auditioner->cancelPendingRenders();
+            
+            const auto presetName = presetList.getText();
+            if (presetName.isNotEmpty() && presetName != presetManager.getCurrentPreset())
+                presetManager.loadPreset(presetName);
+            return;
+        }
+        
+        // The auditioner's renderers are whole processors, so they're only built once someone asks for them.
+        if (auditioner == nullptr)
+            auditioner = std::make_unique<PresetAuditioner>(presetManager, jmax(1, SystemStats::getNumCpus() / 2));
+        
+        const auto sampleRate = previewPlayer.getSampleRate();
+        if (sampleRate != referenceClipSampleRate)
+        {
+            auditioner->setReferenceClip(PresetAuditioner::createReferenceClip(sampleRate), sampleRate);
+            referenceClipSampleRate = sampleRate;
+        }
+        renderAroundSelection();
+    }
+    
+    void auditionPreset(const String& presetName)
+    {
+        previewPlayer.stop();
+        auditioner->requestPreview(presetName, [safeThis = SafePointer<PresetPanel>(this)](const String& renderedName, const AudioBuffer<float>& preview)
+        {
+            // Only the most recent pick is worth hearing.
+            if (safeThis != nullptr && safeThis->auditionButton.getToggleState() && safeThis->presetList.getText() == renderedName)
+                safeThis->previewPlayer.play(preview);
+        });
+        renderAroundSelection();
+    }
+    
+    // The presets next to the selection are the ones most likely to be auditioned next.
+    void renderAroundSelection()
+    {
+        StringArray listedPresets;
+        for (int index = 0; index < presetList.getNumItems(); ++index)
+            listedPresets.add(presetList.getItemText(index));
+        
+        auditioner->renderAround(listedPresets, jmax(0, presetList.getSelectedItemIndex()));
+    }
+    
+    void exportPresetPack(const File& packFile, const StringArray& presetNames, bool flattenDerived)
+    {
+        startPresetPackTransfer(exportButton, presetManager.exportPresetPack(packFile.withFileExtension(PresetPack::extension),
+                                                                             presetNames, flattenDerived,
+                                                                             makeProgressCallback(exportButton),
+                                                                             makeCompletionCallback()));
+    }
+    
+    void startPresetPackTransfer(TextButton& button, bool hasStarted)
+    {
+        if (!hasStarted)
+            return;
+        
+        importButton.setEnabled(false);
+        exportButton.setEnabled(false);
+        button.setButtonText("0%");
+    }
+    
+    // Callbacks can arrive after the editor has closed, so they only touch the panel through a SafePointer.
+    PresetPack::ProgressCallback makeProgressCallback(TextButton& button)
+    {
+        return [safeThis = SafePointer<PresetPanel>(this), &button](int numDone, int numTotal)
+        {
+            if (safeThis != nullptr && numTotal > 0)
+                button.setButtonText(String(numDone * 100 / numTotal) + "%");
+        };
+    }
+    
+    PresetPack::CompletionCallback makeCompletionCallback()
+    {
+        return [safeThis = SafePointer<PresetPanel>(this)](const Result& result)
+        {
+            if (safeThis == nullptr)
+                return;
+            
+            safeThis->importButton.setButtonText("Import");
+            safeThis->exportButton.setButtonText("Export");
+            safeThis->importButton.setEnabled(true);
+            safeThis->exportButton.setEnabled(true);
+            
+            if (result.failed())
+                NativeMessageBox::showMessageBoxAsync(MessageBoxIconType::WarningIcon, "Preset Pack", result.getErrorMessage());
+        };
+    }
+    
+    void updateQuickSlotButtons()
+    {
+        for (int slot = 0; slot < PresetManager::numQuickSlots; ++slot)
+        {
+            const auto isAssigned = presetManager.isQuickSlotAssigned(slot);
+            quickSlotButtons[slot].setToggleState(isAssigned, dontSendNotification);
+            quickSlotButtons[slot].setTooltip(isAssigned ? presetManager.getQuickSlotPresetName(slot) : "Click to store the current sound");
+        }
     }
 
     
     std::unique_ptr<FileChooser> fileChooser;
     
     PresetManager& presetManager;
-    TextButton saveButton, deleteButton, nextButton, previousButton;
+    PreviewPlayer& previewPlayer;
+    std::unique_ptr<PresetAuditioner> auditioner;
+    double referenceClipSampleRate = 0.0;
+    TextButton saveButton, deleteButton, nextButton, previousButton, importButton, exportButton, linkButton, deriveButton, auditionButton, groupButton;
     ComboBox presetList;
+    std::array<TextButton, PresetManager::numQuickSlots> quickSlotButtons;
+    uint32 displayedStateGeneration = 0;
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PresetPanel);
 };
@@ -0,0 +1,268 @@
+/*
+  ==============================================================================
+
+    RealtimeSafety.cpp
+    Created: 19 Oct 2026 6:36:54am
+
+  ==============================================================================
+*/
+
+#include "RealtimeSafety.h"
+
+#if PPM_REALTIME_SAFETY_CHECKS && JUCE_LINUX
+ #include <dlfcn.h>
+ #include <fcntl.h>
+ #include <pthread.h>
+ #include <cstdarg>
+#endif
+
+namespace RealtimeSafety
+{
+    namespace
+    {
+        constexpr int maxReports = 64;
+        
+        thread_local int realtimeScopeDepth = 0;
+        thread_local int permittedLockDepth = 0;
+        thread_local bool isReporting = false;
+        
+        std::array<std::atomic<int>, numViolationTypes> violationCounts{};
+        
+        CriticalSection reportLock;
+        StringArray& getReports()
+        {
+            static StringArray reports;
+            return reports;
+        }
+        
+        const char* getViolationName(Violation type)
+        {
+            switch (type)
+            {
+                case Violation::allocation:         return "Heap allocation";
+                case Violation::lock:               return "Lock acquisition";
+                case Violation::fileIo:             return "File I/O";
+                case Violation::valueTreeMutation:  return "ValueTree mutation";
+            }
+            return "";
+        }
+    }
+    
+    void enterRealtimeScope() noexcept
+    {
+        ++realtimeScopeDepth;
+    }
+    
+    void exitRealtimeScope() noexcept
+    {
+        jassert(realtimeScopeDepth > 0);
+        --realtimeScopeDepth;
+    }
+    
+    bool isInRealtimeScope() noexcept
+    {
+        return realtimeScopeDepth > 0;
+    }
+    
+    void enterPermittedLockScope() noexcept
+    {
+        ++permittedLockDepth;
+    }
+    
+    void exitPermittedLockScope() noexcept
+    {
+        jassert(permittedLockDepth > 0);
+        --permittedLockDepth;
+    }
+    
+    void check(Violation type, const char* operation) noexcept
+    {
+        if (realtimeScopeDepth == 0 || isReporting){
+            return;
+        }
+        
+        if (type == Violation::lock && permittedLockDepth > 0){
+            return;
+        }
+        
+        // Reporting allocates and locks itself, so checking is suspended on this thread until it's done.
+        isReporting = true;
+        violationCounts[(size_t) type].fetch_add(1, std::memory_order_relaxed);
+        
+        const auto report = String(getViolationName(type)) + " in real-time scope: " + operation + newLine
+                          + SystemStats::getStackBacktrace();
+        DBG(report);
+        
+        {
+            const ScopedLock sl(reportLock);
+            auto& reports = getReports();
+            if (reports.size() >= maxReports){
+                reports.remove(0);
+            }
+            reports.add(report);
+        }
+        isReporting = false;
+    }
+    
+    int getViolationCount(Violation type) noexcept
+    {
+        return violationCounts[(size_t) type].load(std::memory_order_relaxed);
+    }
+    
+    int getTotalViolationCount() noexcept
+    {
+        auto total = 0;
+        for (const auto& count : violationCounts){
+            total += count.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+    
+    StringArray getViolationReports()
+    {
+        const ScopedLock sl(reportLock);
+        return getReports();
+    }
+    
+    void resetViolations()
+    {
+        for (auto& count : violationCounts){
+            count.store(0, std::memory_order_relaxed);
+        }
+        
+        const ScopedLock sl(reportLock);
+        getReports().clear();
+    }
+}
+
+#if PPM_REALTIME_SAFETY_CHECKS
+
+// Every replaceable form is replaced, so that none of them slips past the check: array, nothrow, sized
+// and over-aligned allocations all report, and each pointer is freed the way it was allocated.
+namespace
+{
+    void* allocate(std::size_t size, const char* operation) noexcept
+    {
+        RealtimeSafety::check(RealtimeSafety::Violation::allocation, operation);
+        return std::malloc(size == 0 ? 1 : size);
+    }
+    
+    void deallocate(void* memory, const char* operation) noexcept
+    {
+        if (memory != nullptr){
+            RealtimeSafety::check(RealtimeSafety::Violation::allocation, operation);
+        }
+        std::free(memory);
+    }
+    
+    void* throwIfNull(void* memory)
+    {
+        if (memory == nullptr){
+            throw std::bad_alloc();
+        }
+        return memory;
+    }
+    
+   #if __cpp_aligned_new
+    void* allocateAligned(std::size_t size, std::align_val_t alignment, const char* operation) noexcept
+    {
+        RealtimeSafety::check(RealtimeSafety::Violation::allocation, operation);
+        const auto alignmentInBytes = jmax((std::size_t) alignment, sizeof(void*));
+       #if JUCE_WINDOWS
+        return _aligned_malloc(size == 0 ? 1 : size, alignmentInBytes);
+       #else
+        void* memory = nullptr;
+        return posix_memalign(&memory, alignmentInBytes, size == 0 ? 1 : size) == 0 ? memory : nullptr;
+       #endif
+    }
+    
+    void deallocateAligned(void* memory, const char* operation) noexcept
+    {
+        if (memory != nullptr){
+            RealtimeSafety::check(RealtimeSafety::Violation::allocation, operation);
+        }
+       #if JUCE_WINDOWS
+        _aligned_free(memory);
+       #else
+        std::free(memory);
+       #endif
+    }
+   #endif
+}
+
+void* operator new(std::size_t size)                                            { return throwIfNull(allocate(size, "operator new")); }
+void* operator new[](std::size_t size)                                          { return throwIfNull(allocate(size, "operator new[]")); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept            { return allocate(size, "operator new (nothrow)"); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept          { return allocate(size, "operator new[] (nothrow)"); }
+
+void operator delete(void* memory) noexcept                                     { deallocate(memory, "operator delete"); }
+void operator delete[](void* memory) noexcept                                   { deallocate(memory, "operator delete[]"); }
+void operator delete(void* memory, const std::nothrow_t&) noexcept              { deallocate(memory, "operator delete"); }
+void operator delete[](void* memory, const std::nothrow_t&) noexcept            { deallocate(memory, "operator delete[]"); }
+void operator delete(void* memory, std::size_t) noexcept                        { deallocate(memory, "operator delete"); }
+void operator delete[](void* memory, std::size_t) noexcept                      { deallocate(memory, "operator delete[]"); }
+
+ #if __cpp_aligned_new
+void* operator new(std::size_t size, std::align_val_t alignment)                { return throwIfNull(allocateAligned(size, alignment, "operator new (aligned)")); }
+void* operator new[](std::size_t size, std::align_val_t alignment)              { return throwIfNull(allocateAligned(size, alignment, "operator new[] (aligned)")); }
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept    { return allocateAligned(size, alignment, "operator new (aligned, nothrow)"); }
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept  { return allocateAligned(size, alignment, "operator new[] (aligned, nothrow)"); }
+
+void operator delete(void* memory, std::align_val_t) noexcept                                       { deallocateAligned(memory, "operator delete (aligned)"); }
+void operator delete[](void* memory, std::align_val_t) noexcept                                     { deallocateAligned(memory, "operator delete[] (aligned)"); }
+void operator delete(void* memory, std::align_val_t, const std::nothrow_t&) noexcept                { deallocateAligned(memory, "operator delete (aligned)"); }
+void operator delete[](void* memory, std::align_val_t, const std::nothrow_t&) noexcept              { deallocateAligned(memory, "operator delete[] (aligned)"); }
+void operator delete(void* memory, std::size_t, std::align_val_t) noexcept                          { deallocateAligned(memory, "operator delete (aligned)"); }
+void operator delete[](void* memory, std::size_t, std::align_val_t) noexcept                        { deallocateAligned(memory, "operator delete[] (aligned)"); }
+ #endif
+
+ #if JUCE_LINUX
+namespace
+{
+    template <typename Function>
+    Function* findNextSymbol(const char* name)
+    {
+        return reinterpret_cast<Function*>(dlsym(RTLD_NEXT, name));
+    }
+}
+
+extern "C"
+{
+    int pthread_mutex_lock(pthread_mutex_t* mutex)
+    {
+        RealtimeSafety::check(RealtimeSafety::Violation::lock, "pthread_mutex_lock");
+        static auto* const next = findNextSymbol<int(pthread_mutex_t*)>("pthread_mutex_lock");
+        return next(mutex);
+    }
+    
+    int open(const char* path, int flags, ...)
+    {
+        RealtimeSafety::check(RealtimeSafety::Violation::fileIo, "open");
+        va_list args;
+        va_start(args, flags);
+        const auto mode = (flags & O_CREAT) != 0 ? va_arg(args, mode_t) : 0;
+        va_end(args);
+        static auto* const next = findNextSymbol<int(const char*, int, ...)>("open");
+        return next(path, flags, mode);
+    }
+    
+    int open64(const char* path, int flags, ...)
+    {
+        RealtimeSafety::check(RealtimeSafety::Violation::fileIo, "open64");
+        va_list args;
+        va_start(args, flags);
+        const auto mode = (flags & O_CREAT) != 0 ? va_arg(args, mode_t) : 0;
+        va_end(args);
+        static auto* const next = findNextSymbol<int(const char*, int, ...)>("open64");
+        return next(path, flags, mode);
+    }
+    
+    FILE* fopen(const char* path, const char* mode)
+    {
+        RealtimeSafety::check(RealtimeSafety::Violation::fileIo, "fopen");
+        static auto* const next = findNextSymbol<FILE*(const char*, const char*)>("fopen");
+        return next(path, mode);
+    }
+}
+ #endif
+#endif
@@ -0,0 +1,113 @@
+/*
+  ==============================================================================
+
+    RealtimeSafety.h
+    Created: 19 Oct 2026 6:36:54am
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Debug/test instrumentation that reports anything a real-time thread shouldn't do: heap allocations,
+// lock acquisitions, file I/O and ValueTree mutations. It is compiled in only when
+// PPM_REALTIME_SAFETY_CHECKS=1 is defined, because it replaces every global operator new and delete.
+// Locks and file I/O are intercepted on Linux, and only when the checker is linked into the executable
+// itself (as in Tests/PluginPresetManagerTests.jucer), since a plugin loaded by a host can't interpose libc there.
+#ifndef PPM_REALTIME_SAFETY_CHECKS
+ #define PPM_REALTIME_SAFETY_CHECKS 0
+#endif
+
+namespace RealtimeSafety
+{
+    enum class Violation
+    {
+        allocation,
+        lock,
+        fileIo,
+        valueTreeMutation
+    };
+    
+    constexpr int numViolationTypes = 4;
+    
+    void enterRealtimeScope() noexcept;
+    
+    void exitRealtimeScope() noexcept;
+    
+    bool isInRealtimeScope() noexcept;
+    
+    // Records a violation, with a stack trace, if the calling thread is inside a real-time scope.
+    void check(Violation type, const char* operation) noexcept;
+    
+    int getViolationCount(Violation type) noexcept;
+    
+    int getTotalViolationCount() noexcept;
+    
+    // The most recent violation reports, each with the stack it happened on.
+    StringArray getViolationReports();
+    
+    void resetViolations();
+    
+    // Marks the calling thread as real-time for the lifetime of the object. Compiles to nothing when
+    // the checks are disabled.
+    struct ScopedRealtime
+    {
+       #if PPM_REALTIME_SAFETY_CHECKS
+        ScopedRealtime() noexcept   { enterRealtimeScope(); }
+        ~ScopedRealtime() noexcept  { exitRealtimeScope(); }
+       #else
+        ScopedRealtime() noexcept = default;
+        ~ScopedRealtime() noexcept = default;
+       #endif
+        
+        JUCE_DECLARE_NON_COPYABLE(ScopedRealtime)
+    };
+    
+    void enterPermittedLockScope() noexcept;
+    
+    void exitPermittedLockScope() noexcept;
+    
+    // Allows lock acquisitions on the calling thread for the lifetime of the object, while everything else
+    // is still reported. For the few locks a plugin can't avoid, like the one JUCE holds briefly while it
+    // notifies the host of a parameter change. Compiles to nothing when the checks are disabled.
+    struct ScopedPermittedLocks
+    {
+       #if PPM_REALTIME_SAFETY_CHECKS
+        ScopedPermittedLocks() noexcept   { enterPermittedLockScope(); }
+        ~ScopedPermittedLocks() noexcept  { exitPermittedLockScope(); }
+       #else
+        ScopedPermittedLocks() noexcept = default;
+        ~ScopedPermittedLocks() noexcept = default;
+       #endif
+        
+        JUCE_DECLARE_NON_COPYABLE(ScopedPermittedLocks)
+    };
+    
+    // Reports every change made to a ValueTree from inside a real-time scope.
+    class ValueTreeMutationWatcher : private ValueTree::Listener
+    {
+    public:
+        ValueTreeMutationWatcher(ValueTree& treeToWatch) : tree(treeToWatch)
+        {
+            tree.addListener(this);
+        }
+        
+        ~ValueTreeMutationWatcher() override
+        {
+            tree.removeListener(this);
+        }
+        
+    private:
+        void valueTreePropertyChanged(ValueTree&, const Identifier&) override   { check(Violation::valueTreeMutation, "ValueTree property changed"); }
+        void valueTreeChildAdded(ValueTree&, ValueTree&) override               { check(Violation::valueTreeMutation, "ValueTree child added"); }
+        void valueTreeChildRemoved(ValueTree&, ValueTree&, int) override        { check(Violation::valueTreeMutation, "ValueTree child removed"); }
+        void valueTreeChildOrderChanged(ValueTree&, int, int) override          { check(Violation::valueTreeMutation, "ValueTree children reordered"); }
+        void valueTreeRedirected(ValueTree&) override                           { check(Violation::valueTreeMutation, "ValueTree redirected"); }
+        
+        ValueTree& tree;
+        
+        JUCE_DECLARE_NON_COPYABLE(ValueTreeMutationWatcher)
+    };
+}
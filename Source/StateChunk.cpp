@@ -0,0 +1,99 @@
+/*
+  ==============================================================================
+
+    StateChunk.cpp
+    Created: 19 Oct 2026 6:48:38am
+
+  ==============================================================================
+*/
+
+#include "StateChunk.h"
+
+namespace StateChunk
+{
+    // Different from copyXmlToBinary()'s magic number, so legacy blobs can't be mistaken for chunks.
+    constexpr int chunkMagic = 0x53534d50;
+    constexpr int headerSize = 4 + 1 + 4;
+    constexpr uint32 maxStateSize = 64 * 1024 * 1024;
+    constexpr uint32 autosaveIntervalMs = 10000;
+    
+    static int getCompressionLevel(Tier tier, WriteHistory& history)
+    {
+        const auto now = Time::getMillisecondCounter();
+        const auto previous = history.lastWriteTime.exchange(now);
+        const auto beforePrevious = history.previousWriteTime.exchange(previous);
+        
+        // Hosts take undo snapshots and autosaves in quick succession, and a final save on its own. A save
+        // right after a single autosave still counts as on its own: only a run of writes is treated as one.
+        if (tier == Tier::automatic){
+            tier = beforePrevious != 0 && now - beforePrevious < autosaveIntervalMs ? Tier::fast : Tier::small;
+        }
+        
+        switch (tier)
+        {
+            case Tier::fast:            return 1;
+            case Tier::small:           return 9;
+            case Tier::uncompressed:
+            case Tier::automatic:       break;
+        }
+        return 0;
+    }
+    
+    void write(const ValueTree& state, MemoryBlock& destData, Tier tier, WriteHistory& history)
+    {
+        MemoryOutputStream serialised;
+        state.writeToStream(serialised);
+        
+        const auto compressionLevel = getCompressionLevel(tier, history);
+        
+        MemoryOutputStream output{ destData, false };
+        output.writeInt(chunkMagic);
+        output.writeByte((char) (compressionLevel > 0 ? Codec::deflate : Codec::none));
+        output.writeInt((int) serialised.getDataSize());
+        
+        if (compressionLevel > 0)
+        {
+            GZIPCompressorOutputStream compressor{ output, compressionLevel };
+            compressor.write(serialised.getData(), serialised.getDataSize());
+        }
+        else
+        {
+            output.write(serialised.getData(), serialised.getDataSize());
+        }
+    }
+    
+    ValueTree read(const void* data, int sizeInBytes)
+    {
+        MemoryInputStream input{ data, (size_t) jmax(0, sizeInBytes), false };
+        
+        if (sizeInBytes < headerSize || input.readInt() != chunkMagic)
+        {
+            const auto xmlState = AudioProcessor::getXmlFromBinary(data, sizeInBytes);
+            return xmlState != nullptr ? ValueTree::fromXml(*xmlState) : ValueTree{};
+        }
+        
+        const auto codec = static_cast<Codec>(input.readByte());
+        const auto stateSize = (uint32) input.readInt();
+        if (stateSize > maxStateSize){
+            return {};
+        }
+        
+        if (codec == Codec::none){
+            return ValueTree::readFromStream(input);
+        }
+        
+        if (codec == Codec::deflate)
+        {
+            GZIPDecompressorInputStream decompressor{ input };
+            MemoryBlock serialised;
+            if (decompressor.readIntoMemoryBlock(serialised, (ssize_t) stateSize) != stateSize){
+                return {};
+            }
+            return ValueTree::readFromData(serialised.getData(), serialised.getSize());
+        }
+        
+        // Written by a newer version with a codec this one doesn't know.
+        jassertfalse;
+        return {};
+    }
+}
@@ -0,0 +1,45 @@
+/*
+  ==============================================================================
+
+    StateChunk.h
+    Created: 19 Oct 2026 6:48:38am
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// The binary session state handed to the host. A chunk starts with a small header whose codec byte says
+// how the rest is stored, followed by the state as a binary ValueTree, compressed or not. Reading also
+// accepts the plain XML blobs written by copyXmlToBinary() in earlier versions.
+namespace StateChunk
+{
+    enum class Tier
+    {
+        uncompressed,
+        fast,     // Cheap enough for frequent autosaves and host undo snapshots.
+        small,    // Slower, for the final save of a project.
+        automatic // fast while the host keeps asking every few seconds, small otherwise.
+    };
+    
+    enum class Codec : uint8
+    {
+        none = 0,
+        deflate = 1
+    };
+    
+    // When an instance's state was last written, which the automatic tier decides from. Keep one per
+    // processor, so that one instance's autosaves don't change how another's project is saved.
+    struct WriteHistory
+    {
+        std::atomic<uint32> lastWriteTime{ 0 };
+        std::atomic<uint32> previousWriteTime{ 0 };
+    };
+    
+    void write(const ValueTree& state, MemoryBlock& destData, Tier tier, WriteHistory& history);
+    
+    // Returns an invalid tree if the data is neither a chunk nor a legacy XML blob.
+    ValueTree read(const void* data, int sizeInBytes);
+}
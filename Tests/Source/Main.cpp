@@ -0,0 +1,68 @@
+/*
+  ==============================================================================
+
+    This file contains the basic startup code for a JUCE application.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../Source/HostSimulator.h"
+
+#if ! PPM_REALTIME_SAFETY_CHECKS
+ #error "The tests need PPM_REALTIME_SAFETY_CHECKS=1, which PluginPresetManagerTests.jucer and CMakeLists.txt define"
+#endif
+
+//==============================================================================
+// Runs the unit tests, or with --soak, soak tests the processor in a simulated host and fails on deadline
+// misses, inconsistent session state or anything the audio thread does that a real-time thread shouldn't.
+// Soak options:
+//   --seconds <n>             how long to run for (60 by default)
+//   --block-size <n>          samples per block (128 by default)
+//   --no-realtime-priority    for machines that can't grant it, e.g. CI runners
+static bool runUnitTests()
+{
+    juce::UnitTestRunner runner;
+    runner.setAssertOnFailure (false);
+    runner.runTestsInCategory ("PluginPresetManager");
+    
+    for (int index = 0; index < runner.getNumResults(); ++index)
+        if (runner.getResult (index)->failures > 0)
+            return false;
+    
+    return true;
+}
+
+static bool runSoakTest (const juce::ArgumentList& arguments)
+{
+    HostSimulator::Options options;
+    if (arguments.containsOption ("--seconds"))
+        options.duration = juce::RelativeTime::seconds (arguments.getValueForOption ("--seconds").getDoubleValue());
+    if (arguments.containsOption ("--block-size"))
+        options.blockSize = juce::jmax (1, arguments.getValueForOption ("--block-size").getIntValue());
+    options.useRealtimePriority = ! arguments.containsOption ("--no-realtime-priority");
+    
+    const auto report = HostSimulator (options).run();
+    std::cout << report.toString() << std::endl;
+    return report.passed();
+}
+
+int main (int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    const juce::ArgumentList arguments (argc, argv);
+    
+    // Both run on their own thread while this one dispatches messages, as a host's would: the simulator
+    // needs the message thread free to hand out its lock, and the tests wait for work reported on it.
+    std::atomic<bool> passed { false };
+    std::thread testThread ([&passed, &arguments]
+    {
+        passed = arguments.containsOption ("--soak") ? runSoakTest (arguments) : runUnitTests();
+        juce::MessageManager::getInstance()->stopDispatchLoop();
+    });
+    
+    juce::MessageManager::getInstance()->runDispatchLoop();
+    testThread.join();
+    
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,74 @@
+/*
+  ==============================================================================
+
+    ParametersTests.cpp
+    Created: 19 Oct 2026 10:05:12am
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../Source/Parameters.h"
+
+class ParametersTests : public UnitTest
+{
+public:
+    ParametersTests() : UnitTest("Parameters", "PluginPresetManager")
+    {
+    }
+    
+    void runTest() override
+    {
+        beginTest("The hash gives every ID its own slot");
+        {
+            expect(Parameters::isCollisionFree(Parameters::hashSeed));
+            
+            std::set<uint32_t> slots;
+            for (const auto& descriptor : Parameters::descriptors){
+                slots.insert(Parameters::hash(descriptor.id, Parameters::hashSeed) % Parameters::hashTableSize);
+            }
+            expectEquals((int) slots.size(), Parameters::numParameters);
+            
+            const auto numUsedSlots = std::count_if(Parameters::hashTable.begin(), Parameters::hashTable.end(), [](int index) { return index >= 0; });
+            expectEquals((int) numUsedSlots, Parameters::numParameters);
+        }
+        
+        beginTest("indexOf finds every parameter at its descriptor's position");
+        for (int index = 0; index < Parameters::numParameters; ++index)
+        {
+            const auto& descriptor = Parameters::descriptors[(size_t) index];
+            expectEquals(Parameters::indexOf(descriptor.id), index);
+            expectEquals(Parameters::getIndex(Parameters::toString(descriptor.id)), index);
+        }
+        
+        beginTest("indexOf rejects IDs that aren't in the layout");
+        {
+            // IDs that land in a used slot still have to match in full.
+            for (const auto* id : { "", "GAIN", "GAIN_ID ", "gain_id", "GAIN_NAME", "RELEASE_IDX", "NOT_A_PARAMETER" }){
+                expectEquals(Parameters::indexOf(id), -1, id);
+            }
+            
+            Random random{ 3 };
+            for (int attempt = 0; attempt < 1000; ++attempt)
+            {
+                String id;
+                for (int character = random.nextInt({ 1, 16 }); --character >= 0;){
+                    id << (juce_wchar) random.nextInt({ 'A', 'Z' + 1 });
+                }
+                
+                const auto index = Parameters::getIndex(id);
+                expect(index == -1 || Parameters::toString(Parameters::descriptors[(size_t) index].id) == id, id);
+            }
+        }
+        
+        beginTest("Default values come from the descriptors");
+        {
+            const auto values = Parameters::getDefaultValues();
+            for (int index = 0; index < Parameters::numParameters; ++index){
+                expectEquals(values[(size_t) index], Parameters::descriptors[(size_t) index].defaultValue);
+            }
+        }
+    }
+};
+
+static ParametersTests parametersTests;
@@ -0,0 +1,221 @@
+/*
+  ==============================================================================
+
+    PresetCatalogueTests.cpp
+    Created: 19 Oct 2026 10:05:12am
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../Source/PresetCatalogue.h"
+#include "TestPresets.h"
+
+class PresetCatalogueTests : public UnitTest
+{
+public:
+    PresetCatalogueTests() : UnitTest("PresetCatalogue", "PluginPresetManager")
+    {
+    }
+    
+    void runTest() override
+    {
+        testDerivedResolution();
+        testSidecarRoundTrip();
+        testTruncatedSidecars();
+        testCorruptSidecars();
+    }
+    
+private:
+    void testDerivedResolution()
+    {
+        beginTest("Derived presets resolve against their bases");
+        
+        const TestPresets::TemporaryDirectory temporaryDirectory{ "PresetCatalogueTests" };
+        const auto& directory = temporaryDirectory.getDirectory();
+        
+        const Parameters::Values baseValues{ 0.25f, 0.5f, 0.75f, 0.125f };
+        TestPresets::writePreset(directory, "Base", TestPresets::toStoredValues(baseValues));
+        TestPresets::writePreset(directory, "Child", { { 0, 1.0f } }, "Base");
+        TestPresets::writePreset(directory, "Grandchild", { { 2, 0.0f } }, "Child");
+        TestPresets::writePreset(directory, "Identical", {}, "Base");
+        TestPresets::writePreset(directory, "Orphan", { { 0, 0.5f } }, "Missing");
+        TestPresets::writePreset(directory, "Cycle A", { { 0, 0.375f } }, "Cycle B");
+        TestPresets::writePreset(directory, "Cycle B", { { 1, 0.625f } }, "Cycle A");
+        
+        PresetCatalogue catalogue{ directory, TestPresets::extension };
+        const auto snapshot = catalogue.getSnapshot();
+        expect(snapshot != nullptr);
+        expectEquals(snapshot->names.size(), 7);
+        
+        expectValues(*snapshot, "Base", baseValues);
+        expectValues(*snapshot, "Child", { 1.0f, 0.5f, 0.75f, 0.125f });
+        expectValues(*snapshot, "Grandchild", { 1.0f, 0.5f, 0.0f, 0.125f });
+        expectValues(*snapshot, "Identical", baseValues);
+        
+        // A missing base leaves the defaults under whatever the preset stores itself.
+        auto orphanValues = Parameters::getDefaultValues();
+        orphanValues[0] = 0.5f;
+        expectValues(*snapshot, "Orphan", orphanValues);
+        
+        // A cycle of bases resolves without recursing forever, and each preset keeps what it stores.
+        const auto& cycleA = snapshot->entries[(size_t) snapshot->indexOf("Cycle A")];
+        const auto& cycleB = snapshot->entries[(size_t) snapshot->indexOf("Cycle B")];
+        expectEquals(cycleA.values[0], 0.375f);
+        expectEquals(cycleB.values[1], 0.625f);
+    }
+    
+    void testSidecarRoundTrip()
+    {
+        beginTest("The sidecar reloads the catalogue it stored");
+        
+        const TestPresets::TemporaryDirectory temporaryDirectory{ "PresetCatalogueTests" };
+        const auto directory = writeLibrary(temporaryDirectory.getDirectory());
+        const auto sidecar = temporaryDirectory.getDirectory().getChildFile("Library.catalogue");
+        
+        const auto expected = PresetCatalogue{ directory, TestPresets::extension, sidecar }.getSnapshot();
+        expect(sidecar.existsAsFile());
+        
+        // With the directory unchanged, the new catalogue comes from the sidecar alone.
+        expectSnapshotsMatch(*PresetCatalogue{ directory, TestPresets::extension, sidecar }.getSnapshot(), *expected, "Reloaded");
+        expectEquals(PresetCatalogue::readStoredEntryCount(sidecar), (int) expected->entries.size());
+    }
+    
+    void testTruncatedSidecars()
+    {
+        beginTest("Truncated sidecars are rebuilt from the directory");
+        
+        const TestPresets::TemporaryDirectory temporaryDirectory{ "PresetCatalogueTests" };
+        const auto directory = writeLibrary(temporaryDirectory.getDirectory());
+        const auto sidecar = temporaryDirectory.getDirectory().getChildFile("Library.catalogue");
+        
+        const auto expected = PresetCatalogue{ directory, TestPresets::extension, sidecar }.getSnapshot();
+        MemoryBlock sidecarData;
+        expect(sidecar.loadFileAsData(sidecarData));
+        
+        // Cut off at every possible point, from inside the header to the last byte of the last entry.
+        for (size_t size = 0; size < sidecarData.getSize(); ++size)
+        {
+            sidecar.replaceWithData(sidecarData.getData(), size);
+            expectSnapshotsMatch(*PresetCatalogue{ directory, TestPresets::extension, sidecar }.getSnapshot(), *expected,
+                                 "Truncated to " + String((int) size) + " bytes");
+        }
+    }
+    
+    void testCorruptSidecars()
+    {
+        beginTest("Corrupt sidecars are rebuilt from the directory");
+        
+        const TestPresets::TemporaryDirectory temporaryDirectory{ "PresetCatalogueTests" };
+        const auto directory = writeLibrary(temporaryDirectory.getDirectory());
+        const auto sidecar = temporaryDirectory.getDirectory().getChildFile("Library.catalogue");
+        const auto expected = PresetCatalogue{ directory, TestPresets::extension, sidecar }.getSnapshot();
+        
+        const auto expectRebuiltFrom = [&](const MemoryBlock& corruptData, const String& description)
+        {
+            sidecar.replaceWithData(corruptData.getData(), corruptData.getSize());
+            expectSnapshotsMatch(*PresetCatalogue{ directory, TestPresets::extension, sidecar }.getSnapshot(), *expected, description);
+        };
+        
+        const auto directoryModified = directory.getLastModificationTime();
+        expectRebuiltFrom(createSidecar(directoryModified, -1, {}, 0), "Negative entry count");
+        expectRebuiltFrom(createSidecar(directoryModified, std::numeric_limits<int>::max(), {}, 0), "Entry count past the end");
+        expectRebuiltFrom(createSidecar(directoryModified, 1, "Base.preset", std::numeric_limits<int>::max()), "Metadata count past the end");
+        expectRebuiltFrom(createSidecar(directoryModified, 1, "Base.preset", -1), "Negative metadata count");
+        
+        // Entries may only point at files directly inside the directory.
+        for (const auto& path : { String(), String("../Base.preset"), String("Sub/../../Base.preset"),
+                                  String("Sub/Base.preset"), directory.getChildFile("Base.preset").getFullPathName() })
+        {
+            expectRebuiltFrom(createSidecar(directoryModified, 1, path, 0), "Path \"" + path + "\"");
+        }
+        
+        Random random{ 11 };
+        MemoryBlock garbage{ 4096 };
+        for (size_t index = 0; index < garbage.getSize(); ++index){
+            garbage[index] = (char) random.nextInt(256);
+        }
+        expectRebuiltFrom(garbage, "Random bytes");
+    }
+    
+    // A few plain and derived presets, one with metadata, in a folder of their own.
+    static File writeLibrary(const File& parent)
+    {
+        const auto directory = parent.getChildFile("Presets");
+        directory.createDirectory();
+        
+        Random random{ 5 };
+        for (int index = 0; index < 6; ++index){
+            TestPresets::writePreset(directory, "Preset " + String(index), TestPresets::toStoredValues(TestPresets::createRandomValues(random)));
+        }
+        
+        StringPairArray metadata;
+        metadata.set("cluster", "High GAIN_NAME");
+        TestPresets::writePreset(directory, "Base", TestPresets::toStoredValues(TestPresets::createRandomValues(random)), {}, metadata);
+        TestPresets::writePreset(directory, "Derived", { { 1, 0.5f }, { 3, 0.25f } }, "Base", metadata);
+        return directory;
+    }
+    
+    // A sidecar in the current format holding one made-up entry, or only the header if there are none.
+    static MemoryBlock createSidecar(Time directoryModified, int numEntries, const String& relativePath, int numMetadata)
+    {
+        MemoryOutputStream output;
+        output.writeInt(0x434d5050);
+        output.writeInt(1);
+        output.writeInt((int) Parameters::layoutHash);
+        output.writeInt(Parameters::numParameters);
+        output.writeInt64(directoryModified.toMilliseconds());
+        output.writeInt(numEntries);
+        
+        if (numEntries > 0)
+        {
+            output.writeString("Base");
+            output.writeString(relativePath);
+            for (int field = 0; field < 3; ++field){
+                output.writeInt64(0);
+            }
+            output.writeString({});
+            
+            for (int parameter = 0; parameter < Parameters::numParameters; ++parameter)
+            {
+                output.writeBool(true);
+                output.writeFloat(0.0f);
+            }
+            output.writeInt(numMetadata);
+        }
+        return output.getMemoryBlock();
+    }
+    
+    void expectValues(const PresetCatalogue::Snapshot& snapshot, const String& presetName, const Parameters::Values& expectedValues)
+    {
+        const auto index = snapshot.indexOf(presetName);
+        expect(index >= 0, presetName + " is missing");
+        if (index < 0){
+            return;
+        }
+        
+        for (int parameter = 0; parameter < Parameters::numParameters; ++parameter){
+            expectEquals(snapshot.entries[(size_t) index].values[(size_t) parameter], expectedValues[(size_t) parameter], presetName);
+        }
+    }
+    
+    void expectSnapshotsMatch(const PresetCatalogue::Snapshot& actual, const PresetCatalogue::Snapshot& expected, const String& description)
+    {
+        expect(actual.names == expected.names, description + ": different presets");
+        if (actual.names != expected.names){
+            return;
+        }
+        
+        for (size_t index = 0; index < expected.entries.size(); ++index)
+        {
+            const auto& actualEntry = actual.entries[index];
+            const auto& expectedEntry = expected.entries[index];
+            expect(actualEntry.values == expectedEntry.values, description + ": different values for " + expectedEntry.name);
+            expect(actualEntry.basePresetName == expectedEntry.basePresetName, description + ": different base for " + expectedEntry.name);
+            expect(actualEntry.metadata == expectedEntry.metadata, description + ": different metadata for " + expectedEntry.name);
+            expect(actualEntry.file == expectedEntry.file, description + ": different file for " + expectedEntry.name);
+        }
+    }
+};
+
+static PresetCatalogueTests presetCatalogueTests;
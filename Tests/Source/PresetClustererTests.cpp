@@ -0,0 +1,112 @@
+/*
+  ==============================================================================
+
+    PresetClustererTests.cpp
+    Created: 19 Oct 2026 10:05:12am
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../Source/PresetClusterer.h"
+
+class PresetClustererTests : public UnitTest
+{
+public:
+    PresetClustererTests() : UnitTest("PresetClusterer", "PluginPresetManager")
+    {
+    }
+    
+    void runTest() override
+    {
+        beginTest("Presets that differ in one parameter are grouped and named by it");
+        {
+            // Two tight groups, far apart in gain and close together in everything else.
+            std::vector<std::pair<String, Parameters::Values>> presets;
+            Random random{ 17 };
+            for (int index = 0; index < 12; ++index)
+            {
+                const auto jitter = random.nextFloat() * 0.02f;
+                presets.push_back({ "Loud " + String(index), { 0.9f, 0.5f + jitter, 0.5f, 0.5f } });
+                presets.push_back({ "Quiet " + String(index), { 0.1f, 0.5f, 0.5f - jitter, 0.5f } });
+            }
+            
+            const auto labels = cluster(presets, 2);
+            expectEquals((int) labels.size(), (int) presets.size());
+            
+            const auto gainName = Parameters::toString(Parameters::descriptors[0].name);
+            for (const auto& [name, values] : presets)
+            {
+                const auto found = labels.find(name);
+                const auto expectedLabel = (values[0] > 0.5f ? "High " : "Low ") + gainName;
+                expect(found != labels.end() && found->second == expectedLabel, name + " labelled " + (found != labels.end() ? found->second : "nothing"));
+            }
+        }
+        
+        beginTest("The same library is labelled the same way every time");
+        {
+            std::vector<std::pair<String, Parameters::Values>> presets;
+            Random random{ 19 };
+            for (int index = 0; index < 200; ++index)
+            {
+                Parameters::Values values;
+                for (auto& value : values){
+                    value = random.nextFloat();
+                }
+                presets.push_back({ "Preset " + String(index), values });
+            }
+            
+            const auto labels = cluster(presets, 0);
+            expectEquals((int) labels.size(), (int) presets.size());
+            expect(labels == cluster(presets, 0));
+            
+            std::set<String> groups;
+            for (const auto& label : labels){
+                groups.insert(label.second);
+            }
+            expect(groups.size() >= 2 && groups.size() <= 12);
+        }
+        
+        beginTest("More groups than distinct presets still labels every preset");
+        {
+            std::vector<std::pair<String, Parameters::Values>> presets;
+            for (int index = 0; index < 3; ++index){
+                presets.push_back({ "Same " + String(index), Parameters::getDefaultValues() });
+            }
+            
+            const auto labels = cluster(presets, 5);
+            expectEquals((int) labels.size(), (int) presets.size());
+        }
+        
+        beginTest("An empty library has no labels");
+        expect(cluster({}, 4).empty());
+    }
+    
+private:
+    // Clusters a catalogue of already resolved presets, and waits for the labels.
+    static PresetClusterer::Labels cluster(const std::vector<std::pair<String, Parameters::Values>>& presets, int numClusters)
+    {
+        auto snapshot = std::make_shared<PresetCatalogue::Snapshot>();
+        for (const auto& [name, values] : presets)
+        {
+            PresetCatalogue::Entry entry;
+            entry.name = name;
+            entry.values = values;
+            snapshot->entries.push_back(std::move(entry));
+        }
+        
+        PresetClusterer clusterer{ 4 };
+        PresetClusterer::Labels labels;
+        WaitableEvent finished;
+        clusterer.start(snapshot, numClusters, [&](PresetClusterer::Labels&& clusteredLabels)
+        {
+            labels = std::move(clusteredLabels);
+            finished.signal();
+        });
+        
+        finished.wait(60000);
+        return labels;
+    }
+};
+
+static PresetClustererTests presetClustererTests;
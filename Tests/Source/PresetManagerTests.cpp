@@ -0,0 +1,112 @@
+/*
+  ==============================================================================
+
+    PresetManagerTests.cpp
+    Created: 19 Oct 2026 10:05:12am
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../Source/PluginProcessor.h"
+#include "TestPresets.h"
+
+class PresetManagerTests : public UnitTest
+{
+public:
+    PresetManagerTests() : UnitTest("PresetManager", "PluginPresetManager")
+    {
+    }
+    
+    void runTest() override
+    {
+        // The tests run off the message thread, which the processor and its preset manager belong to.
+        const MessageManagerLock mmLock;
+        
+        const TestPresets::TemporaryDirectory temporaryDirectory{ "PresetManagerTests" };
+        const auto& directory = temporaryDirectory.getDirectory();
+        
+        PluginPresetManagerAudioProcessor processor;
+        auto& presetManager = processor.getPresetManager();
+        presetManager.setLayers({ { "User", directory, true } });
+        presetManager.setDerivedStorageEnabled(true);
+        
+        const Parameters::Values baseValues{ 0.25f, 0.5f, 0.75f, 0.125f };
+        const Parameters::Values childValues{ 1.0f, 0.5f, 0.75f, 0.125f };
+        const Parameters::Values grandchildValues{ 1.0f, 0.5f, 0.0f, 0.125f };
+        
+        beginTest("Presets saved from another one only store what differs");
+        {
+            presetManager.applyParameterValues(baseValues);
+            presetManager.savePreset("Base");
+            
+            presetManager.applyParameterValues(childValues);
+            presetManager.savePreset("Child");
+            
+            presetManager.applyParameterValues(grandchildValues);
+            presetManager.savePreset("Grandchild");
+            
+            expectStored(directory, "Base", {}, Parameters::numParameters);
+            expectStored(directory, "Child", "Base", 1);
+            expectStored(directory, "Grandchild", "Child", 1);
+        }
+        
+        beginTest("Derived presets load with their bases' values");
+        {
+            expectValues(presetManager, "Base", baseValues);
+            expectValues(presetManager, "Child", childValues);
+            expectValues(presetManager, "Grandchild", grandchildValues);
+            
+            presetManager.loadPreset("Base");
+            presetManager.loadPreset("Grandchild");
+            expect(presetManager.readParameterSnapshot() == grandchildValues);
+        }
+        
+        beginTest("Overwriting a base flattens the presets derived from it");
+        {
+            // Shorter as text, so the rewritten file differs in size as well as time.
+            const Parameters::Values newBaseValues{ 0.5f, 0.25f, 0.5f, 0.75f };
+            presetManager.loadPreset("Base");
+            presetManager.applyParameterValues(newBaseValues);
+            presetManager.savePreset("Base");
+            
+            expectValues(presetManager, "Base", newBaseValues);
+            expectValues(presetManager, "Child", childValues);
+            expectValues(presetManager, "Grandchild", grandchildValues);
+            
+            // The child is now stored in full, and the grandchild still derives from it.
+            expectStored(directory, "Child", {}, Parameters::numParameters);
+            expectStored(directory, "Grandchild", "Child", 1);
+        }
+        
+        beginTest("Deleting a base flattens the presets derived from it");
+        {
+            presetManager.deletePreset("Child");
+            expect(!presetManager.getAllPresets().contains("Child"));
+            expectValues(presetManager, "Grandchild", grandchildValues);
+            expectStored(directory, "Grandchild", {}, Parameters::numParameters);
+        }
+    }
+    
+private:
+    void expectStored(const File& directory, const String& presetName, const String& expectedBaseName, int expectedNumParameters)
+    {
+        const auto xmlState = XmlDocument::parse(directory.getChildFile(presetName + "." + TestPresets::extension));
+        expect(xmlState != nullptr, presetName + " was not saved");
+        if (xmlState == nullptr){
+            return;
+        }
+        
+        expectEquals(xmlState->getStringAttribute("basePreset"), expectedBaseName, presetName);
+        expectEquals(xmlState->getNumChildElements(), expectedNumParameters, presetName);
+    }
+    
+    void expectValues(PresetManager& presetManager, const String& presetName, const Parameters::Values& expectedValues)
+    {
+        const auto values = presetManager.getPresetValues(presetName);
+        expect(values.has_value(), presetName + " is missing");
+        expect(values.has_value() && *values == expectedValues, presetName + " has the wrong values");
+    }
+};
+
+static PresetManagerTests presetManagerTests;
@@ -0,0 +1,193 @@
+/*
+  ==============================================================================
+
+    PresetPackTests.cpp
+    Created: 19 Oct 2026 10:05:12am
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../Source/PresetPack.h"
+#include "TestPresets.h"
+
+class PresetPackTests : public UnitTest
+{
+public:
+    PresetPackTests() : UnitTest("PresetPack", "PluginPresetManager")
+    {
+    }
+    
+    void runTest() override
+    {
+        const TestPresets::TemporaryDirectory temporaryDirectory{ "PresetPackTests" };
+        const auto source = temporaryDirectory.getDirectory().getChildFile("Source");
+        const auto packFile = temporaryDirectory.getDirectory().getChildFile("Library." + PresetPack::extension);
+        const auto presets = writeLibrary(source);
+        
+        PresetPack presetPack{ 4 };
+        
+        beginTest("Export writes every preset");
+        {
+            std::vector<PresetPack::ExportItem> items;
+            for (const auto& file : presets){
+                items.push_back({ file.getFileNameWithoutExtension(), file, {} });
+            }
+            
+            const auto result = runToCompletion(presetPack, [&](PresetPack::CompletionCallback onComplete)
+            {
+                return presetPack.exportPack(std::move(items), packFile, nullptr, std::move(onComplete));
+            });
+            expect(result.wasOk(), result.getErrorMessage());
+            expect(packFile.existsAsFile());
+        }
+        
+        const auto importDirectory = temporaryDirectory.getDirectory().getChildFile("Import");
+        
+        beginTest("Import restores every preset exactly");
+        {
+            std::vector<PresetCatalogue::Entry> indexed;
+            const auto result = importPack(presetPack, packFile, importDirectory, indexed);
+            expect(result.wasOk(), result.getErrorMessage());
+            expectEquals((int) indexed.size(), presets.size());
+            
+            for (const auto& file : presets){
+                expectSameContent(importDirectory.getChildFile(file.getFileName()), file);
+            }
+            
+            for (const auto& entry : indexed)
+            {
+                PresetCatalogue::Entry decoded;
+                MemoryBlock content;
+                expect(entry.file.loadFileAsData(content) && PresetCatalogue::decodeEntry(decoded, content), entry.name);
+                expect(entry.storedValues == decoded.storedValues && entry.basePresetName == decoded.basePresetName, entry.name);
+            }
+        }
+        
+        beginTest("Importing the same pack again adds nothing");
+        {
+            const auto numFiles = importDirectory.getNumberOfChildFiles(File::TypesOfFileToFind::findFiles);
+            std::vector<PresetCatalogue::Entry> indexed;
+            expect(importPack(presetPack, packFile, importDirectory, indexed).wasOk());
+            expectEquals(importDirectory.getNumberOfChildFiles(File::TypesOfFileToFind::findFiles), numFiles);
+        }
+        
+        beginTest("Import never overwrites a different preset, and follows renamed bases");
+        {
+            const auto destination = temporaryDirectory.getDirectory().getChildFile("Conflict");
+            destination.createDirectory();
+            const auto existing = TestPresets::writePreset(destination, "Base", { { 0, 0.0f } });
+            const auto existingContent = existing.loadFileAsString();
+            
+            std::vector<PresetCatalogue::Entry> indexed;
+            expect(importPack(presetPack, packFile, destination, indexed).wasOk());
+            expectEquals(existing.loadFileAsString(), existingContent);
+            
+            const auto renamedBase = destination.getChildFile("Base (2)." + TestPresets::extension);
+            expectSameContent(renamedBase, source.getChildFile("Base." + TestPresets::extension));
+            
+            const auto derivedState = XmlDocument::parse(destination.getChildFile("Derived." + TestPresets::extension));
+            expect(derivedState != nullptr && derivedState->getStringAttribute("basePreset") == "Base (2)");
+        }
+        
+        beginTest("Damaged packs import what is intact and report the damage");
+        {
+            MemoryBlock packData;
+            expect(packFile.loadFileAsData(packData));
+            
+            const auto damagedFile = temporaryDirectory.getDirectory().getChildFile("Damaged." + PresetPack::extension);
+            damagedFile.replaceWithData(packData.getData(), packData.getSize() / 2);
+            
+            const auto destination = temporaryDirectory.getDirectory().getChildFile("Damaged");
+            std::vector<PresetCatalogue::Entry> indexed;
+            const auto result = importPack(presetPack, damagedFile, destination, indexed);
+            expect(result.failed());
+            expect(!indexed.empty() && (int) indexed.size() < presets.size());
+            
+            // Whatever was imported is complete.
+            for (const auto& entry : indexed){
+                expectSameContent(entry.file, source.getChildFile(entry.file.getFileName()));
+            }
+            
+            // One flipped byte in a preset's compressed data fails that preset's checks, and only that one.
+            auto corruptData = packData;
+            corruptData[corruptData.getSize() - 16] ^= 0x5a;
+            damagedFile.replaceWithData(corruptData.getData(), corruptData.getSize());
+            
+            const auto corruptDestination = temporaryDirectory.getDirectory().getChildFile("Corrupt");
+            indexed.clear();
+            expect(importPack(presetPack, damagedFile, corruptDestination, indexed).failed());
+            expectEquals((int) indexed.size(), presets.size() - 1);
+            
+            damagedFile.replaceWithText("Not a preset pack");
+            indexed.clear();
+            expect(importPack(presetPack, damagedFile, temporaryDirectory.getDirectory().getChildFile("NotAPack"), indexed).failed());
+            expect(indexed.empty());
+        }
+    }
+    
+private:
+    // More presets than fit in one batch, with a derived preset whose base comes after it in the pack.
+    static Array<File> writeLibrary(const File& directory)
+    {
+        directory.createDirectory();
+        
+        Array<File> files;
+        files.add(TestPresets::writePreset(directory, "Derived", { { 0, 0.5f } }, "Base"));
+        
+        Random random{ 13 };
+        for (int index = 0; index < 150; ++index){
+            files.add(TestPresets::writePreset(directory, "Preset " + String(index), TestPresets::toStoredValues(TestPresets::createRandomValues(random))));
+        }
+        
+        files.add(TestPresets::writePreset(directory, "Base", TestPresets::toStoredValues(TestPresets::createRandomValues(random))));
+        return files;
+    }
+    
+    // Completion is reported on the message thread, which the test runner leaves free to dispatch.
+    static Result runToCompletion(PresetPack& presetPack, const std::function<bool(PresetPack::CompletionCallback)>& startTask)
+    {
+        // Shared with the callback, which may still arrive after a timeout.
+        auto finished = std::make_shared<WaitableEvent>();
+        auto result = std::make_shared<Result>(Result::fail("Timed out"));
+        const auto onComplete = [finished, result](const Result& completedResult)
+        {
+            *result = completedResult;
+            finished->signal();
+        };
+        
+        if (!startTask(onComplete)){
+            return Result::fail("Another import or export is running");
+        }
+        
+        finished->wait(60000);
+        
+        // Completion is posted just before the worker thread finishes, so wait for it before the next task.
+        while (presetPack.isBusy()){
+            Thread::sleep(1);
+        }
+        return *result;
+    }
+    
+    static Result importPack(PresetPack& presetPack, const File& packFile, const File& destination,
+                             std::vector<PresetCatalogue::Entry>& indexed)
+    {
+        return runToCompletion(presetPack, [&](PresetPack::CompletionCallback onComplete)
+        {
+            return presetPack.importPack(packFile, destination, TestPresets::extension, [&indexed](std::vector<PresetCatalogue::Entry>&& entries)
+            {
+                indexed = std::move(entries);
+            }, nullptr, std::move(onComplete));
+        });
+    }
+    
+    void expectSameContent(const File& actual, const File& expected)
+    {
+        MemoryBlock actualContent;
+        MemoryBlock expectedContent;
+        expect(actual.loadFileAsData(actualContent) && expected.loadFileAsData(expectedContent) && actualContent == expectedContent,
+               actual.getFileName() + " differs from " + expected.getFileName());
+    }
+};
+
+static PresetPackTests presetPackTests;
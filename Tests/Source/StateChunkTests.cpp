@@ -0,0 +1,98 @@
+/*
+  ==============================================================================
+
+    StateChunkTests.cpp
+    Created: 19 Oct 2026 10:05:12am
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../Source/StateChunk.h"
+
+class StateChunkTests : public UnitTest
+{
+public:
+    StateChunkTests() : UnitTest("StateChunk", "PluginPresetManager")
+    {
+    }
+    
+    void runTest() override
+    {
+        const auto state = createState();
+        
+        beginTest("Every tier reads back the state it wrote");
+        for (const auto tier : { StateChunk::Tier::uncompressed, StateChunk::Tier::fast, StateChunk::Tier::small, StateChunk::Tier::automatic })
+        {
+            StateChunk::WriteHistory history;
+            
+            // A run of writes, so that the automatic tier goes through both of its levels.
+            for (int write = 0; write < 3; ++write)
+            {
+                MemoryBlock data;
+                StateChunk::write(state, data, tier, history);
+                
+                const auto expectedCodec = tier == StateChunk::Tier::uncompressed ? StateChunk::Codec::none : StateChunk::Codec::deflate;
+                expect(data.getSize() > 5 && static_cast<StateChunk::Codec>(data[4]) == expectedCodec, "Wrong codec for tier " + String((int) tier));
+                expect(StateChunk::read(data.getData(), (int) data.getSize()).isEquivalentTo(state), "Tier " + String((int) tier) + " did not round-trip");
+            }
+        }
+        
+        beginTest("Legacy XML blobs are still read");
+        {
+            const auto xmlState = state.createXml();
+            MemoryBlock legacyData;
+            AudioProcessor::copyXmlToBinary(*xmlState, legacyData);
+            
+            // XML keeps every property as text, so the trees are compared as XML.
+            const auto restored = StateChunk::read(legacyData.getData(), (int) legacyData.getSize());
+            expect(restored.isValid());
+            expect(restored.createXml()->isEquivalentTo(xmlState.get(), false));
+        }
+        
+        beginTest("Damaged chunks are rejected");
+        {
+            StateChunk::WriteHistory history;
+            MemoryBlock data;
+            StateChunk::write(state, data, StateChunk::Tier::small, history);
+            
+            for (const auto size : { 0, 3, 9, (int) data.getSize() / 2 }){
+                expect(!StateChunk::read(data.getData(), size).isValid(), "Truncated to " + String(size) + " bytes");
+            }
+            
+            // A size past the limit is refused before anything is allocated for it.
+            auto oversized = data;
+            oversized.copyFrom("\xff\xff\xff\x7f", 5, 4);
+            expect(!StateChunk::read(oversized.getData(), (int) oversized.getSize()).isValid());
+            
+            Random random{ 7 };
+            MemoryBlock garbage{ 256 };
+            for (size_t index = 0; index < garbage.getSize(); ++index){
+                garbage[index] = (char) random.nextInt(256);
+            }
+            expect(!StateChunk::read(garbage.getData(), (int) garbage.getSize()).isValid());
+        }
+    }
+    
+private:
+    static ValueTree createState()
+    {
+        ValueTree state{ "TREE" };
+        state.setProperty("presetName", "Round Trip", nullptr);
+        state.setProperty("version", "1.0.0", nullptr);
+        state.setProperty("derivedStorage", true, nullptr);
+        
+        for (int index = 0; index < 16; ++index)
+        {
+            state.appendChild(ValueTree{ "PARAM", {
+                { "id", "PARAM_" + String(index) },
+                { "value", index / 16.0 }
+            }}, nullptr);
+        }
+        
+        state.appendChild(ValueTree{ "QUICK_SLOTS", { { "slot0", "Round Trip" } } }, nullptr);
+        return state;
+    }
+};
+
+static StateChunkTests stateChunkTests;
@@ -0,0 +1,97 @@
+/*
+  ==============================================================================
+
+    TestPresets.h
+    Created: 19 Oct 2026 10:05:12am
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "../../Source/Parameters.h"
+
+// Helpers shared by the unit tests, for building preset libraries in throwaway folders.
+namespace TestPresets
+{
+    const String extension{ "preset" };
+    
+    // A folder in the temp directory that is deleted again with the object.
+    class TemporaryDirectory
+    {
+    public:
+        explicit TemporaryDirectory(const String& name)
+            : directory(File::getSpecialLocation(File::SpecialLocationType::tempDirectory).getNonexistentChildFile(name, {}, false))
+        {
+            directory.createDirectory();
+        }
+        
+        ~TemporaryDirectory()
+        {
+            directory.deleteRecursively();
+        }
+        
+        const File& getDirectory() const noexcept
+        {
+            return directory;
+        }
+        
+    private:
+        const File directory;
+        
+        JUCE_DECLARE_NON_COPYABLE(TemporaryDirectory)
+    };
+    
+    // The XML a preset file holds, storing only the given parameters, as a derived preset does.
+    inline String createPresetXml(const std::map<int, float>& storedValues, const String& basePresetName = {},
+                                  const StringPairArray& metadata = {})
+    {
+        XmlElement xmlState{ "TREE" };
+        xmlState.setAttribute("presetName", String());
+        if (basePresetName.isNotEmpty()){
+            xmlState.setAttribute("basePreset", basePresetName);
+        }
+        for (int index = 0; index < metadata.size(); ++index){
+            xmlState.setAttribute(metadata.getAllKeys()[index], metadata.getAllValues()[index]);
+        }
+        
+        for (const auto& [index, value] : storedValues)
+        {
+            auto* parameterElement = xmlState.createNewChildElement("PARAM");
+            parameterElement->setAttribute("id", Parameters::toString(Parameters::descriptors[(size_t) index].id));
+            parameterElement->setAttribute("value", value);
+        }
+        return xmlState.toString();
+    }
+    
+    inline std::map<int, float> toStoredValues(const Parameters::Values& values)
+    {
+        std::map<int, float> storedValues;
+        for (int index = 0; index < Parameters::numParameters; ++index){
+            storedValues[index] = values[(size_t) index];
+        }
+        return storedValues;
+    }
+    
+    inline File writePreset(const File& directory, const String& presetName, const std::map<int, float>& storedValues,
+                            const String& basePresetName = {}, const StringPairArray& metadata = {})
+    {
+        const auto file = directory.getChildFile(presetName + "." + extension);
+        file.replaceWithText(createPresetXml(storedValues, basePresetName, metadata));
+        return file;
+    }
+    
+    // Every parameter at a random point of its range. Values are multiples of 1/64, so they survive being
+    // written out as text and read back exactly.
+    inline Parameters::Values createRandomValues(Random& random)
+    {
+        Parameters::Values values;
+        for (int index = 0; index < Parameters::numParameters; ++index)
+        {
+            const auto& descriptor = Parameters::descriptors[(size_t) index];
+            values[(size_t) index] = jmap((float) random.nextInt(65) / 64.0f, descriptor.minValue, descriptor.maxValue);
+        }
+        return values;
+    }
+}